@@ -52,6 +52,29 @@ typedef uint64_t lp_id_t;
 typedef void (*ProcessEvent_t)(lp_id_t me, simtime_t now, unsigned event_type, const void *event_content,
     unsigned event_size, void *st);
 
+/**
+ * @brief ReverseEvent callback function
+ * @param me The logical process ID of the called LP
+ * @param now The simulation time of the event to undo
+ * @param event_type The (model-specific) type of the event to undo
+ * @param event_content The (model-specific) content of the event to undo
+ * @param event_size The size of the event content
+ * @param st The current state of the logical process
+ *
+ * This function is called by the simulation kernel when an event is rolled back, if set in the configuration. It must
+ * revert the changes made to the simulation state by the ProcessEvent_t call with the same arguments. The events of an
+ * LP are undone in the opposite order of their processing, so the state is the one left by the event to undo.
+ *
+ * The information destroyed by an event, which can't be recomputed, should be saved in the forward direction with
+ * rs_bitlog_push() and retrieved here with rs_bitlog_pop().
+ *
+ * @warning No new event can be scheduled in this function.
+ * @warning Memory released with rs_free() while processing an event can't be recovered: models should defer such
+ * releases to events which are never undone.
+ */
+typedef void (*ReverseEvent_t)(lp_id_t me, simtime_t now, unsigned event_type, const void *event_content,
+    unsigned event_size, void *st);
+
 /**
  * @brief Determine if simulation can be halted.
  * @param me The logical process ID of the called LP
@@ -68,6 +91,20 @@ typedef void (*ProcessEvent_t)(lp_id_t me, simtime_t now, unsigned event_type, c
  */
 typedef bool (*CanEnd_t)(lp_id_t me, const void *snapshot);
 
+/**
+ * @brief Determine the worker thread which hosts an LP
+ * @param lp_id The logical process ID of the LP to place
+ * @param n_workers The total number of worker threads, across all the nodes
+ *
+ * @return the ID of the worker thread which hosts the LP, which must be lower than @p n_workers
+ *
+ * Worker threads are numbered node by node: the thread t of the node n has ID n * n_threads + t. Placing the LPs which
+ * communicate the most on the same worker thread, or at least on the same node, makes their messages cheaper.
+ *
+ * @warning The function must return the same value every time it is called with the same arguments.
+ */
+typedef unsigned (*LpPlacement_t)(lp_id_t lp_id, unsigned n_workers);
+
 enum rootsim_event {LP_INIT = 65534, LP_FINI};
 
 /**
@@ -93,6 +130,45 @@ extern void *rs_calloc(size_t nmemb, size_t size);
 extern void rs_free(void *ptr);
 extern void *rs_realloc(void *ptr, size_t req_size);
 
+/// The size exponent of the memory chunks whose writes are tracked by __write_mem()
+#define RS_WRITE_CHUNK_EXP 6
+
+/// The LP memory buffer hit by the last write reported with __write_mem() in the thread
+struct rs_write_cache {
+	/// The first byte of the memory buffer
+	unsigned char *base;
+	/// The size in bytes of the memory buffer, 0 if no buffer is cached
+	size_t size;
+	/// The dirty bitmap of the memory buffer, a bit for each chunk
+	unsigned char *dirty;
+};
+
+extern __thread struct rs_write_cache __write_mem_cache;
+extern void __write_mem_slow(const void *ptr, size_t s);
+
+/**
+ * @brief Report a write to memory, for the incremental checkpoints
+ * @param ptr the first written byte
+ * @param s the size in bytes of the write
+ *
+ * A write within a single chunk of the cached memory buffer is marked in place, the others go through the lookup of
+ * the LP buffers in __write_mem_slow(). The instrumentation pass emits the same code in front of the model writes.
+ */
+static inline void __write_mem(const void *ptr, size_t s)
+{
+	size_t off = (size_t)((uintptr_t)ptr - (uintptr_t)__write_mem_cache.base);
+	size_t last = off + s - 1;
+	if(last < __write_mem_cache.size && !((off ^ last) >> RS_WRITE_CHUNK_EXP)) {
+		size_t c = off >> RS_WRITE_CHUNK_EXP;
+		__write_mem_cache.dirty[c / CHAR_BIT] |= (unsigned char)(1U << (c % CHAR_BIT));
+		return;
+	}
+	__write_mem_slow(ptr, s);
+}
+
+extern void rs_bitlog_push(uint64_t bits, unsigned width);
+extern uint64_t rs_bitlog_pop(unsigned width);
+
 enum log_level {
 	LOG_TRACE,  //!< The logging level reserved to very low priority messages
 	LOG_DEBUG,  //!< The logging level reserved to useful debug messages
@@ -123,12 +199,31 @@ struct simulation_configuration {
 	unsigned ckpt_interval;
 	/// If set, worker threads are bound to physical cores
 	bool core_binding;
+	/// If set, idle worker threads take over LPs, together with their pending events, from the busiest ones
+	bool work_stealing;
+	/// The count of GVT computations between two rebalancing of the LPs across threads, 0 to disable it
+	unsigned rebalance_period;
+	/// If set, the messages sent by rolled back events are annihilated only if their re-execution doesn't send them
+	bool lazy_cancellation;
+	/// The minimum delay of the events scheduled by the model. If not zero, the simulation is run conservatively
+	/// and scheduling an event within the lookahead aborts it
+	simtime_t lookahead;
+	/// If set with a lookahead, the quiet LPs process their safe messages conservatively, the rest optimistically
+	bool hybrid_synchronization;
+	/// If set, the threads can't process messages too far beyond the GVT, within a window tuned on the rollbacks
+	bool optimism_throttling;
 	/// If set, the simulation will run on the serial runtime
 	bool serial;
 	/// Function pointer to the dispatching function
 	ProcessEvent_t dispatcher;
+	/// Function pointer to the reverse dispatching function. If not NULL, it replaces checkpoints in rollbacks
+	ReverseEvent_t reverse_dispatcher;
 	/// Function pointer to the termination detection function
 	CanEnd_t committed;
+	/// Function pointer to the LP placement function. If NULL, LPs are split in contiguous blocks of IDs
+	LpPlacement_t placement;
+	/// Path to a file listing the worker thread ID of each LP, in order. If not NULL, it overrides the placement
+	const char *placement_file;
 };
 
 extern int RootsimInit(const struct simulation_configuration *conf);
@@ -0,0 +1,120 @@
+/**
+ * @file datatypes/bitlog.h
+ *
+ * @brief Bit log datatype
+ *
+ * A stack of bit fields of arbitrary width, packed in 64 bit words, whose oldest words can be discarded
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#pragma once
+
+#include <datatypes/array.h>
+
+#include <stdint.h>
+
+/// A bit log, the bits past its end in its last word are always zero
+struct bitlog {
+	/// The words holding the logged bits
+	dyn_array(uint64_t) words;
+	/// The count of bits discarded from the head of the log since its initialization, always a multiple of 64
+	uint64_t base;
+	/// The count of bits logged since the initialization of the log, including the discarded ones
+	uint64_t end;
+};
+
+/**
+ * @brief Initialize a bit log
+ * @param self the bit log to initialize
+ */
+#define bitlog_init(self)                                                                                              \
+	__extension__({                                                                                                \
+		array_init((self)->words);                                                                             \
+		(self)->base = 0;                                                                                      \
+		(self)->end = 0;                                                                                       \
+	})
+
+/**
+ * @brief Finalize a bit log
+ * @param self the bit log to finalize
+ */
+#define bitlog_fini(self) array_fini((self)->words)
+
+/**
+ * @brief Get the position of the end of a bit log
+ * @param self the target bit log
+ * @return the count of bits logged in @p self since its initialization, including the discarded ones
+ */
+#define bitlog_end(self) ((self)->end)
+
+/**
+ * @brief Get the count of bits which can be popped from a bit log
+ * @param self the target bit log
+ * @return the count of bits held in @p self, not counting the discarded ones
+ */
+#define bitlog_size(self) ((self)->end - (self)->base)
+
+/**
+ * @brief Push a bit field on a bit log
+ * @param bl the target bit log
+ * @param bits the value of the bit field, only its @p n least significant bits are logged
+ * @param n the width of the bit field, between 1 and 64
+ */
+static inline void bitlog_push(struct bitlog *bl, uint64_t bits, unsigned n)
+{
+	if(n < 64)
+		bits &= (UINT64_C(1) << n) - 1;
+
+	unsigned s = bitlog_size(bl) % 64;
+	if(!s) {
+		array_push(bl->words, bits);
+	} else {
+		array_peek(bl->words) |= bits << s;
+		if(s + n > 64)
+			array_push(bl->words, bits >> (64 - s));
+	}
+	bl->end += n;
+}
+
+/**
+ * @brief Pop a bit field from a bit log
+ * @param bl the target bit log
+ * @param n the width of the bit field, between 1 and 64, it must not exceed bitlog_size()
+ * @return the value of the bit field
+ */
+static inline uint64_t bitlog_pop(struct bitlog *bl, unsigned n)
+{
+	bl->end -= n;
+	uint64_t off = bitlog_size(bl);
+	array_count_t w = off / 64;
+	unsigned s = off % 64;
+
+	uint64_t ret = array_get_at(bl->words, w) >> s;
+	if(s + n > 64)
+		ret |= array_get_at(bl->words, w + 1) << (64 - s);
+	if(n < 64)
+		ret &= (UINT64_C(1) << n) - 1;
+
+	array_count(bl->words) = w + (s != 0);
+	if(s)
+		array_get_at(bl->words, w) &= (UINT64_C(1) << s) - 1;
+	return ret;
+}
+
+/**
+ * @brief Discard the oldest bits of a bit log
+ * @param bl the target bit log
+ * @param pos the position, as returned by bitlog_end(), before which the bits can be discarded
+ *
+ * Only whole words are discarded, so some bits before @p pos may be kept.
+ */
+static inline void bitlog_discard(struct bitlog *bl, uint64_t pos)
+{
+	array_count_t k = (pos - bl->base) / 64;
+	if(!k)
+		return;
+
+	array_truncate_first(bl->words, k);
+	bl->base += (uint64_t)k * 64;
+}
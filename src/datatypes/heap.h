@@ -3,15 +3,25 @@
  *
  * @brief Heap datatype
  *
- * A very simple binary heap implemented on top of our dynamic array
+ * A very simple binary heap implemented on top of our dynamic array, plus a 4-ary heap which keeps the timestamp keys
+ * of its elements in a separate cache aligned array. In the latter, the keys of the children of a node fill half of a
+ * cache line, so that each level of a sift down costs a single cache miss and the minimum child is found with a couple
+ * of vector compares.
  *
  * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
  * SPDX-License-Identifier: GPL-3.0-only
  */
 #pragma once
 
+#include <core/core.h>
 #include <datatypes/array.h>
 
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 /**
  * @brief Declares a heap
  * @param type the type of the contained elements
@@ -84,31 +94,6 @@
 		i;                                                                                                     \
 	})
 
-/**
- * @brief Insert n elements into the heap
- * @param self the heap target of the insertion
- * @param cmp_f a comparing function f(a, b) which returns true iff a < b
- * @param ins the set of elements to insert
- * @param n the number of elements in the set
- * @returns the position of the inserted element in the underlying array
- *
- * For correct operation of the heap you need to always pass the same @a cmp_f, both for insertion and extraction
- */
-#define heap_insert_n(self, cmp_f, ins, n)                                                                             \
-	__extension__({                                                                                                \
-		array_reserve(self, n);                                                                                \
-		__typeof(array_count(self)) j = n;                                                                     \
-		__typeof__(array_items(self)) items = array_items(self);                                               \
-		while(j--) {                                                                                           \
-			__typeof(array_count(self)) i = array_count(self)++;                                           \
-			while(i && cmp_f((ins)[j], items[(i - 1U) / 2U])) {                                            \
-				items[i] = items[(i - 1U) / 2U];                                                       \
-				i = (i - 1U) / 2U;                                                                     \
-			}                                                                                              \
-			items[i] = (ins)[j];                                                                           \
-		}                                                                                                      \
-	})
-
 /**
  * @brief Extract an element from the heap
  * @param self the heap from where to extract the element
@@ -136,3 +121,501 @@
 		items[j] = last;                                                                                       \
 		ret;                                                                                                   \
 	})
+
+/**
+ * @brief Move an element towards the root of the heap until the heap property is restored
+ * @param self the target heap
+ * @param cmp_f a comparing function f(a, b) which returns true iff a < b
+ * @param upd_f a function f(elem, i) called every time an element is placed in the position i of the heap
+ * @param i the current position of the element to move
+ * @returns the final position of the moved element
+ *
+ * This, together with heap_sift_down() and heap_remove_at(), allows to keep track of the positions of the elements in
+ * the heap, so that their priority can be later changed or they can be removed.
+ */
+#define heap_sift_up(self, cmp_f, upd_f, i)                                                                            \
+	__extension__({                                                                                                \
+		__typeof__(array_items(self)) h_items = array_items(self);                                             \
+		__typeof(array_count(self)) h_i = (i);                                                                 \
+		__typeof(*array_items(self)) h_elem = h_items[h_i];                                                    \
+		while(h_i && cmp_f(h_elem, h_items[(h_i - 1U) / 2U])) {                                                \
+			h_items[h_i] = h_items[(h_i - 1U) / 2U];                                                       \
+			upd_f(h_items[h_i], h_i);                                                                      \
+			h_i = (h_i - 1U) / 2U;                                                                         \
+		}                                                                                                      \
+		h_items[h_i] = h_elem;                                                                                 \
+		upd_f(h_items[h_i], h_i);                                                                              \
+		h_i;                                                                                                   \
+	})
+
+/**
+ * @brief Move an element towards the leaves of the heap until the heap property is restored
+ * @param self the target heap
+ * @param cmp_f a comparing function f(a, b) which returns true iff a < b
+ * @param upd_f a function f(elem, i) called every time an element is placed in the position i of the heap
+ * @param i the current position of the element to move
+ * @returns the final position of the moved element
+ */
+#define heap_sift_down(self, cmp_f, upd_f, i)                                                                          \
+	__extension__({                                                                                                \
+		__typeof__(array_items(self)) h_items = array_items(self);                                             \
+		__typeof(array_count(self)) h_cnt = array_count(self);                                                 \
+		__typeof(array_count(self)) h_j = (i);                                                                 \
+		__typeof(array_count(self)) h_i = h_j * 2U + 1U;                                                       \
+		__typeof(*array_items(self)) h_elem = h_items[h_j];                                                    \
+		while(h_i < h_cnt) {                                                                                   \
+			h_i += h_i + 1U < h_cnt && cmp_f(h_items[h_i + 1U], h_items[h_i]);                             \
+			if(!cmp_f(h_items[h_i], h_elem))                                                               \
+				break;                                                                                 \
+			h_items[h_j] = h_items[h_i];                                                                   \
+			upd_f(h_items[h_j], h_j);                                                                      \
+			h_j = h_i;                                                                                     \
+			h_i = h_i * 2U + 1U;                                                                           \
+		}                                                                                                      \
+		h_items[h_j] = h_elem;                                                                                 \
+		upd_f(h_items[h_j], h_j);                                                                              \
+		h_j;                                                                                                   \
+	})
+
+/**
+ * @brief Remove the element at a given position from the heap
+ * @param self the heap from where to remove the element
+ * @param cmp_f a comparing function f(a, b) which returns true iff a < b
+ * @param upd_f a function f(elem, i) called every time an element is placed in the position i of the heap
+ * @param i the position of the element to remove
+ * @returns the removed element
+ */
+#define heap_remove_at(self, cmp_f, upd_f, i)                                                                          \
+	__extension__({                                                                                                \
+		__typeof(array_count(self)) h_r = (i);                                                                 \
+		__typeof(*array_items(self)) h_ret = array_items(self)[h_r];                                           \
+		__typeof(*array_items(self)) h_last = array_pop(self);                                                 \
+		if(h_r < array_count(self)) {                                                                          \
+			array_items(self)[h_r] = h_last;                                                               \
+			if(heap_sift_up(self, cmp_f, upd_f, h_r) == h_r)                                               \
+				heap_sift_down(self, cmp_f, upd_f, h_r);                                               \
+		}                                                                                                      \
+		h_ret;                                                                                                 \
+	})
+
+/**
+ * @brief A placeholder function for heap_sift_up() and heap_sift_down(), when positions need not to be tracked
+ * @param elem the element placed in the heap
+ * @param i the position of the element in the heap
+ */
+#define heap_pos_ignore(elem, i)
+
+/// The count of appended elements starting from which heap_heapify_tail() repairs the heap bottom-up
+#define HEAP_HEAPIFY_THRESHOLD 8U
+
+/**
+ * @brief Restore the heap property after some elements have been appended to the underlying array
+ * @param self the target heap
+ * @param cmp_f a comparing function f(a, b) which returns true iff a < b
+ * @param n the count of elements appended at the end of the underlying array
+ *
+ * Few elements are simply moved up one at a time. Otherwise, the ancestors of the appended elements are sifted down
+ * level by level, from the deepest one to the root, as in Floyd's heap construction: every subtree is repaired only
+ * once, so that the cost is linear in @p n plus a polylogarithmic term in the size of the heap.
+ */
+#define heap_heapify_tail(self, cmp_f, n)                                                                              \
+	__extension__({                                                                                                \
+		__typeof(array_count(self)) h_lo = array_count(self) - (n);                                            \
+		__typeof(array_count(self)) h_hi = array_count(self) - 1U;                                             \
+		if((n) < HEAP_HEAPIFY_THRESHOLD) {                                                                     \
+			for(; h_lo < array_count(self); ++h_lo)                                                        \
+				heap_sift_up(self, cmp_f, heap_pos_ignore, h_lo);                                      \
+		} else {                                                                                               \
+			__typeof(array_count(self)) h_done = array_count(self);                                        \
+			while(h_done && h_hi) {                                                                        \
+				h_lo = h_lo ? (h_lo - 1U) / 2U : 0U;                                                   \
+				h_hi = (h_hi - 1U) / 2U;                                                               \
+				__typeof(array_count(self)) h_q = h_hi < h_done ? h_hi + 1U : h_done;                  \
+				while(h_q-- > h_lo)                                                                    \
+					heap_sift_down(self, cmp_f, heap_pos_ignore, h_q);                             \
+				h_done = h_lo;                                                                         \
+			}                                                                                              \
+		}                                                                                                      \
+	})
+
+/**
+ * @brief Insert n elements into the heap
+ * @param self the heap target of the insertion
+ * @param cmp_f a comparing function f(a, b) which returns true iff a < b
+ * @param ins the set of elements to insert
+ * @param n the number of elements in the set
+ *
+ * The elements are appended all at once and the heap is then repaired with heap_heapify_tail(), which is cheaper than
+ * inserting them one at a time when @p n is large.
+ * For correct operation of the heap you need to always pass the same @a cmp_f, both for insertion and extraction
+ */
+#define heap_insert_n(self, cmp_f, ins, n)                                                                             \
+	__extension__({                                                                                                \
+		__typeof(array_count(self)) h_n = (n);                                                                 \
+		array_reserve(self, h_n);                                                                              \
+		memcpy(array_items(self) + array_count(self), (ins), h_n * sizeof(*array_items(self)));                \
+		array_count(self) += h_n;                                                                              \
+		heap_heapify_tail(self, cmp_f, h_n);                                                                   \
+	})
+
+/// The count of children of each node in a d-ary heap
+#define DHEAP_ARITY 4U
+
+/**
+ * @brief Declares a d-ary heap
+ * @param type the type of the contained elements
+ *
+ * The keys of the elements are stored apart from them. The keys array is shifted so that the children of every node
+ * start at a cache aligned index; its unused slots always hold INFINITY, so that the children of a node can be
+ * scanned without checking the heap bounds.
+ */
+#define dheap_declare(type)                                                                                            \
+	struct {                                                                                                       \
+		simtime_t *keys;                                                                                       \
+		type *items;                                                                                           \
+		array_count_t count;                                                                                   \
+		array_count_t capacity;                                                                                \
+	}
+
+/**
+ * @brief Gets the underlying array of keys of a d-ary heap
+ * @param self the target heap
+ * @return a pointer to the underlying array of keys
+ */
+#define dheap_keys(self) ((self).keys)
+
+/**
+ * @brief Gets the underlying array of elements of a d-ary heap
+ * @param self the target heap
+ * @return a pointer to the underlying array of elements
+ *
+ * You can use the returned array to directly index items, but do it at your own risk!
+ */
+#define dheap_items(self) ((self).items)
+
+/**
+ * @brief Gets the count of contained element in a d-ary heap
+ * @param self the target heap
+ * @return the count of contained elements
+ */
+#define dheap_count(self) ((self).count)
+
+/**
+ * @brief Check if a d-ary heap is empty
+ * @param self the heap to check
+ * @return true if @p self heap is empty, false otherwise
+ */
+#define dheap_is_empty(self) (dheap_count(self) == 0)
+
+/**
+ * @brief Get the highest priority element of a d-ary heap
+ * @param self the heap
+ * @return the highest priority element
+ */
+#define dheap_min(self) (dheap_items(self)[0])
+
+/**
+ * @brief Get the key of the highest priority element of a d-ary heap
+ * @param self the heap
+ * @return the key of the highest priority element, INFINITY if @p self is empty
+ */
+#define dheap_min_key(self) (dheap_keys(self)[0])
+
+/**
+ * @brief A placeholder tie breaking function for d-ary heaps, when elements with equal keys need not to be ordered
+ * @param a the first element
+ * @param b the second element
+ */
+#define dheap_no_tie(a, b) false
+
+/**
+ * @brief Allocates the keys array of a d-ary heap
+ * @param cap the capacity of the heap
+ * @return a pointer to the slot of the root key in the new array
+ */
+static inline simtime_t *dheap_keys_alloc(array_count_t cap)
+{
+	size_t n = cap + 2 * (DHEAP_ARITY - 1U);
+	size_t size = (n * sizeof(simtime_t) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+	simtime_t *keys = mm_aligned_alloc(CACHE_LINE_SIZE, size);
+	for(size_t i = 0; i < n; ++i)
+		keys[i] = INFINITY;
+	return keys + DHEAP_ARITY - 1U;
+}
+
+/**
+ * @brief Frees the keys array of a d-ary heap
+ * @param keys the pointer returned by dheap_keys_alloc()
+ */
+static inline void dheap_keys_free(simtime_t *keys)
+{
+	mm_aligned_free(keys - (DHEAP_ARITY - 1U));
+}
+
+/**
+ * @brief Computes which children of a node in a d-ary heap have the lowest key
+ * @param keys the keys array of the heap
+ * @param c the position of the first child of the node
+ * @param cnt the count of elements in the heap, must be greater than @p c
+ * @return a bitmask in which the i-th bit is set if the child in position @p c + i has the lowest key
+ */
+static inline unsigned dheap_min_children(const simtime_t *keys, array_count_t c, array_count_t cnt)
+{
+#ifdef __SSE2__
+	__m128d a = _mm_load_pd(keys + c);
+	__m128d b = _mm_load_pd(keys + c + 2);
+	__m128d m = _mm_min_pd(a, b);
+	m = _mm_min_pd(m, _mm_shuffle_pd(m, m, 1));
+	unsigned mask = (unsigned)_mm_movemask_pd(_mm_cmpeq_pd(a, m)) |
+	                (unsigned)_mm_movemask_pd(_mm_cmpeq_pd(b, m)) << 2U;
+#else
+	simtime_t m = keys[c];
+	for(unsigned i = 1; i < DHEAP_ARITY; ++i)
+		m = keys[c + i] < m ? keys[c + i] : m;
+	unsigned mask = 0;
+	for(unsigned i = 0; i < DHEAP_ARITY; ++i)
+		mask |= (unsigned)(keys[c + i] == m) << i;
+#endif
+	if(unlikely(cnt - c < DHEAP_ARITY))
+		mask &= (1U << (cnt - c)) - 1U;
+	return mask;
+}
+
+/**
+ * @brief Initialize an empty d-ary heap
+ * @param self the heap to initialize
+ */
+#define dheap_init(self)                                                                                               \
+	__extension__({                                                                                                \
+		(self).count = 0;                                                                                      \
+		(self).capacity = INIT_SIZE_ARRAY;                                                                     \
+		(self).keys = dheap_keys_alloc(INIT_SIZE_ARRAY);                                                       \
+		(self).items = mm_alloc(sizeof(*(self).items) * INIT_SIZE_ARRAY);                                      \
+	})
+
+/**
+ * @brief Finalize a d-ary heap
+ * @param self the heap to finalize
+ *
+ * The user is responsible for cleaning up the possibly contained items.
+ */
+#define dheap_fini(self)                                                                                               \
+	__extension__({                                                                                                \
+		dheap_keys_free((self).keys);                                                                          \
+		mm_free((self).items);                                                                                 \
+	})
+
+/**
+ * @brief Reserve space for a given number of elements in a d-ary heap
+ * @param self the target heap
+ * @param n the count of elements to reserve space for
+ */
+#define dheap_reserve(self, n)                                                                                         \
+	__extension__({                                                                                                \
+		array_count_t h_tcnt = (self).count + (n);                                                             \
+		if(unlikely(h_tcnt >= (self).capacity)) {                                                              \
+			do {                                                                                           \
+				(self).capacity *= 2;                                                                  \
+			} while(unlikely(h_tcnt >= (self).capacity));                                                  \
+			simtime_t *h_keys = dheap_keys_alloc((self).capacity);                                         \
+			memcpy(h_keys, (self).keys, (self).count * sizeof(*h_keys));                                   \
+			dheap_keys_free((self).keys);                                                                  \
+			(self).keys = h_keys;                                                                          \
+			(self).items = mm_realloc((self).items, (self).capacity * sizeof(*(self).items));              \
+		}                                                                                                      \
+	})
+
+/**
+ * @brief Append an element to a d-ary heap, without restoring the heap property
+ * @param self the target heap
+ * @param key the key of the element
+ * @param elem the element to append
+ *
+ * After one or more appends, the heap property has to be restored with dheap_heapify_tail()
+ */
+#define dheap_push(self, key, elem)                                                                                    \
+	__extension__({                                                                                                \
+		dheap_reserve(self, 1);                                                                                \
+		(self).keys[(self).count] = (key);                                                                     \
+		(self).items[(self).count] = (elem);                                                                   \
+		(self).count++;                                                                                        \
+	})
+
+/**
+ * @brief Shrink a d-ary heap, dropping its last elements
+ * @param self the target heap
+ * @param n the new count of elements, not greater than the current one
+ *
+ * This is meant to be used after the elements have been filtered in place, see dheap_heapify_tail().
+ */
+#define dheap_truncate(self, n)                                                                                        \
+	__extension__({                                                                                                \
+		array_count_t h_n = (n);                                                                               \
+		for(array_count_t h_i = h_n; h_i < (self).count; ++h_i)                                                \
+			(self).keys[h_i] = INFINITY;                                                                   \
+		(self).count = h_n;                                                                                    \
+	})
+
+/**
+ * @brief Move an element of a d-ary heap towards the root until the heap property is restored
+ * @param self the target heap
+ * @param tie_f a comparing function f(a, b) which returns true iff a < b, used only for elements with equal keys
+ * @param upd_f a function f(elem, i) called every time an element is placed in the position i of the heap
+ * @param i the current position of the element to move
+ * @returns the final position of the moved element
+ */
+#define dheap_sift_up(self, tie_f, upd_f, i)                                                                           \
+	__extension__({                                                                                                \
+		simtime_t *h_keys = (self).keys;                                                                       \
+		__typeof__((self).items) h_items = (self).items;                                                       \
+		array_count_t h_i = (i);                                                                               \
+		simtime_t h_k = h_keys[h_i];                                                                           \
+		__typeof(*(self).items) h_elem = h_items[h_i];                                                         \
+		while(h_i) {                                                                                           \
+			array_count_t h_p = (h_i - 1U) / DHEAP_ARITY;                                                  \
+			if(!(h_k < h_keys[h_p] || (h_k == h_keys[h_p] && tie_f(h_elem, h_items[h_p]))))                \
+				break;                                                                                 \
+			h_keys[h_i] = h_keys[h_p];                                                                     \
+			h_items[h_i] = h_items[h_p];                                                                   \
+			upd_f(h_items[h_i], h_i);                                                                      \
+			h_i = h_p;                                                                                     \
+		}                                                                                                      \
+		h_keys[h_i] = h_k;                                                                                     \
+		h_items[h_i] = h_elem;                                                                                 \
+		upd_f(h_items[h_i], h_i);                                                                              \
+		h_i;                                                                                                   \
+	})
+
+/**
+ * @brief Move an element of a d-ary heap towards the leaves until the heap property is restored
+ * @param self the target heap
+ * @param tie_f a comparing function f(a, b) which returns true iff a < b, used only for elements with equal keys
+ * @param upd_f a function f(elem, i) called every time an element is placed in the position i of the heap
+ * @param i the current position of the element to move
+ * @returns the final position of the moved element
+ */
+#define dheap_sift_down(self, tie_f, upd_f, i)                                                                         \
+	__extension__({                                                                                                \
+		simtime_t *h_keys = (self).keys;                                                                       \
+		__typeof__((self).items) h_items = (self).items;                                                       \
+		array_count_t h_cnt = (self).count;                                                                    \
+		array_count_t h_j = (i);                                                                               \
+		array_count_t h_c;                                                                                     \
+		simtime_t h_k = h_keys[h_j];                                                                           \
+		__typeof(*(self).items) h_elem = h_items[h_j];                                                         \
+		while((h_c = h_j * DHEAP_ARITY + 1U) < h_cnt) {                                                        \
+			unsigned h_mask = dheap_min_children(h_keys, h_c, h_cnt);                                      \
+			array_count_t h_m = h_c + (unsigned)__builtin_ctz(h_mask);                                     \
+			for(h_mask &= h_mask - 1U; unlikely(h_mask); h_mask &= h_mask - 1U) {                          \
+				array_count_t h_o = h_c + (unsigned)__builtin_ctz(h_mask);                             \
+				if(tie_f(h_items[h_o], h_items[h_m]))                                                  \
+					h_m = h_o;                                                                     \
+			}                                                                                              \
+			if(!(h_keys[h_m] < h_k || (h_keys[h_m] == h_k && tie_f(h_items[h_m], h_elem))))                \
+				break;                                                                                 \
+			h_keys[h_j] = h_keys[h_m];                                                                     \
+			h_items[h_j] = h_items[h_m];                                                                   \
+			upd_f(h_items[h_j], h_j);                                                                      \
+			h_j = h_m;                                                                                     \
+		}                                                                                                      \
+		h_keys[h_j] = h_k;                                                                                     \
+		h_items[h_j] = h_elem;                                                                                 \
+		upd_f(h_items[h_j], h_j);                                                                              \
+		h_j;                                                                                                   \
+	})
+
+/**
+ * @brief Insert an element into a d-ary heap
+ * @param self the heap target of the insertion
+ * @param tie_f a comparing function f(a, b) which returns true iff a < b, used only for elements with equal keys
+ * @param upd_f a function f(elem, i) called every time an element is placed in the position i of the heap
+ * @param key the key of the element to insert
+ * @param elem the element to insert
+ * @returns the position of the inserted element in the underlying array
+ *
+ * For correct operation of the heap you need to always pass the same @a tie_f
+ */
+#define dheap_insert(self, tie_f, upd_f, key, elem)                                                                    \
+	__extension__({                                                                                                \
+		dheap_push(self, key, elem);                                                                           \
+		dheap_sift_up(self, tie_f, upd_f, (self).count - 1U);                                                  \
+	})
+
+/**
+ * @brief Remove the element at a given position from a d-ary heap
+ * @param self the heap from where to remove the element
+ * @param tie_f a comparing function f(a, b) which returns true iff a < b, used only for elements with equal keys
+ * @param upd_f a function f(elem, i) called every time an element is placed in the position i of the heap
+ * @param i the position of the element to remove
+ * @returns the removed element
+ */
+#define dheap_remove_at(self, tie_f, upd_f, i)                                                                         \
+	__extension__({                                                                                                \
+		array_count_t h_r = (i);                                                                               \
+		__typeof(*(self).items) h_ret = (self).items[h_r];                                                     \
+		array_count_t h_last = --(self).count;                                                                 \
+		if(h_r < h_last) {                                                                                     \
+			(self).keys[h_r] = (self).keys[h_last];                                                        \
+			(self).items[h_r] = (self).items[h_last];                                                      \
+			(self).keys[h_last] = INFINITY;                                                                \
+			if(dheap_sift_up(self, tie_f, upd_f, h_r) == h_r)                                              \
+				dheap_sift_down(self, tie_f, upd_f, h_r);                                              \
+		} else {                                                                                               \
+			(self).keys[h_last] = INFINITY;                                                                \
+		}                                                                                                      \
+		h_ret;                                                                                                 \
+	})
+
+/**
+ * @brief Extract the highest priority element from a d-ary heap
+ * @param self the heap from where to extract the element, it must not be empty
+ * @param tie_f a comparing function f(a, b) which returns true iff a < b, used only for elements with equal keys
+ * @param upd_f a function f(elem, i) called every time an element is placed in the position i of the heap
+ * @returns the extracted element
+ */
+#define dheap_extract(self, tie_f, upd_f)                                                                              \
+	__extension__({                                                                                                \
+		__typeof(*(self).items) h_top = (self).items[0];                                                       \
+		array_count_t h_n = --(self).count;                                                                    \
+		if(likely(h_n)) {                                                                                      \
+			(self).keys[0] = (self).keys[h_n];                                                             \
+			(self).items[0] = (self).items[h_n];                                                           \
+			(self).keys[h_n] = INFINITY;                                                                   \
+			dheap_sift_down(self, tie_f, upd_f, 0U);                                                       \
+		} else {                                                                                               \
+			(self).keys[0] = INFINITY;                                                                     \
+		}                                                                                                      \
+		h_top;                                                                                                 \
+	})
+
+/**
+ * @brief Restore the heap property after some elements have been appended to a d-ary heap with dheap_push()
+ * @param self the target heap
+ * @param tie_f a comparing function f(a, b) which returns true iff a < b, used only for elements with equal keys
+ * @param upd_f a function f(elem, i) called every time an element is placed in the position i of the heap
+ * @param n the count of elements appended at the end of the heap
+ *
+ * This works as heap_heapify_tail(), but the positions of all the elements, moved or not, are reported to @p upd_f.
+ * Passing the count of all the elements rebuilds the whole heap.
+ */
+#define dheap_heapify_tail(self, tie_f, upd_f, n)                                                                      \
+	__extension__({                                                                                                \
+		array_count_t h_lo = (self).count - (n);                                                               \
+		array_count_t h_hi = (self).count - 1U;                                                                \
+		if((n) < HEAP_HEAPIFY_THRESHOLD) {                                                                     \
+			for(; h_lo < (self).count; ++h_lo)                                                             \
+				dheap_sift_up(self, tie_f, upd_f, h_lo);                                               \
+		} else {                                                                                               \
+			for(array_count_t h_q = h_lo; h_q < (self).count; ++h_q)                                       \
+				upd_f((self).items[h_q], h_q);                                                         \
+			array_count_t h_done = (self).count;                                                           \
+			while(h_done && h_hi) {                                                                        \
+				h_lo = h_lo ? (h_lo - 1U) / DHEAP_ARITY : 0U;                                          \
+				h_hi = (h_hi - 1U) / DHEAP_ARITY;                                                      \
+				array_count_t h_q = h_hi < h_done ? h_hi + 1U : h_done;                                \
+				while(h_q-- > h_lo)                                                                    \
+					dheap_sift_down(self, tie_f, upd_f, h_q);                                      \
+				h_done = h_lo;                                                                         \
+			}                                                                                              \
+		}                                                                                                      \
+	})
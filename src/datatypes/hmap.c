@@ -0,0 +1,123 @@
+/**
+ * @file datatypes/hmap.c
+ *
+ * @brief Hash map datatype
+ *
+ * Keys are spread across the slots with a Fibonacci hash and collisions are resolved with linear probing. Removals
+ * shift back the following entries of the probe sequence instead of leaving tombstones behind, so that lookups never
+ * scan more than the entries sharing a cluster, however long the hash map has been in use.
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#include <datatypes/hmap.h>
+
+#include <mm/mm.h>
+
+#include <string.h>
+
+/// The count of slots allocated at the first insertion in an hash map
+#define HMAP_INIT_SLOTS 16U
+
+/**
+ * @brief Place an entry in an hash map, without checking for duplicate keys or free slots
+ * @param h the target hash map
+ * @param key the key of the entry
+ * @param val the value of the entry
+ */
+static inline void hmap_place(struct hmap *h, uint64_t key, uint64_t val)
+{
+	array_count_t i = hmap_home(h, key);
+	while(h->slots[i].key)
+		i = (i + 1) & h->mask;
+	h->slots[i].key = key;
+	h->slots[i].val = val;
+}
+
+/**
+ * @brief Double the slots of an hash map, re-placing its entries
+ * @param h the hash map to grow
+ */
+static void hmap_grow(struct hmap *h)
+{
+	struct hmap_slot *old = h->slots;
+	array_count_t old_n = old != NULL ? h->mask + 1 : 0;
+	array_count_t n = old_n ? old_n * 2 : HMAP_INIT_SLOTS;
+
+	h->slots = mm_alloc(n * sizeof(*h->slots));
+	memset(h->slots, 0, n * sizeof(*h->slots));
+	h->mask = n - 1;
+
+	for(array_count_t i = 0; i < old_n; ++i)
+		if(old[i].key)
+			hmap_place(h, old[i].key, old[i].val);
+	mm_free(old);
+}
+
+/**
+ * @brief Insert an entry in an hash map, replacing the value of the key if already present
+ * @param h the target hash map
+ * @param key the key of the entry, it must be non-zero
+ * @param val the value of the entry
+ */
+void hmap_insert(struct hmap *h, uint64_t key, uint64_t val)
+{
+	if(unlikely(h->slots == NULL || (h->count + 1) * 4 > (h->mask + 1) * 3))
+		hmap_grow(h);
+
+	array_count_t i = hmap_home(h, key);
+	while(h->slots[i].key) {
+		if(h->slots[i].key == key) {
+			h->slots[i].val = val;
+			return;
+		}
+		i = (i + 1) & h->mask;
+	}
+	h->slots[i].key = key;
+	h->slots[i].val = val;
+	++h->count;
+}
+
+/**
+ * @brief Remove the entry held in a slot of an hash map
+ * @param h the target hash map
+ * @param i the index of the slot, which must not be free
+ *
+ * Another entry may be moved into the freed slot, so a scan of the slots removing entries must examine the same slot
+ * again before moving on.
+ */
+void hmap_remove_at(struct hmap *h, array_count_t i)
+{
+	// move back the following entries which would be unreachable with the slot freed
+	for(array_count_t j = (i + 1) & h->mask; h->slots[j].key; j = (j + 1) & h->mask) {
+		array_count_t home = hmap_home(h, h->slots[j].key);
+		if(((j - home) & h->mask) >= ((j - i) & h->mask)) {
+			h->slots[i] = h->slots[j];
+			i = j;
+		}
+	}
+	h->slots[i].key = 0;
+	--h->count;
+}
+
+/**
+ * @brief Remove an entry from an hash map
+ * @param h the target hash map
+ * @param key the key of the entry to remove, it must be non-zero
+ * @return true if the entry was present, false otherwise
+ */
+bool hmap_remove(struct hmap *h, uint64_t key)
+{
+	if(unlikely(!h->count))
+		return false;
+
+	array_count_t i = hmap_home(h, key);
+	while(h->slots[i].key != key) {
+		if(!h->slots[i].key)
+			return false;
+		i = (i + 1) & h->mask;
+	}
+
+	hmap_remove_at(h, i);
+	return true;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file datatypes/hmap.h
+ *
+ * @brief Hash map datatype
+ *
+ * An open addressing hash map from non-zero 64 bit keys to 64 bit values
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#pragma once
+
+#include <core/core.h>
+#include <datatypes/array.h>
+
+#include <stdint.h>
+
+/// A slot of an hash map, free if its key is zero
+struct hmap_slot {
+	/// The key of the entry held in this slot
+	uint64_t key;
+	/// The value of the entry held in this slot
+	uint64_t val;
+};
+
+/// An open addressing hash map with linear probing
+struct hmap {
+	/// The slots of the hash map, their count is a power of two
+	struct hmap_slot *slots;
+	/// The count of slots minus one, used to wrap around indexes
+	array_count_t mask;
+	/// The count of entries in the hash map
+	array_count_t count;
+};
+
+/**
+ * @brief Compute the slot from which the probing for a key starts
+ * @param self the target hash map
+ * @param key the key to look for
+ * @return the index of the home slot of @p key
+ */
+#define hmap_home(self, key) ((array_count_t)(((key) * UINT64_C(0x9e3779b97f4a7c15)) >> 32) & (self)->mask)
+
+/**
+ * @brief Initialize an hash map
+ * @param self the hash map to initialize
+ *
+ * No memory is allocated until the first insertion.
+ */
+#define hmap_init(self)                                                                                                \
+	__extension__({                                                                                                \
+		(self)->slots = NULL;                                                                                  \
+		(self)->mask = 0;                                                                                      \
+		(self)->count = 0;                                                                                     \
+	})
+
+/**
+ * @brief Finalize an hash map
+ * @param self the hash map to finalize
+ */
+#define hmap_fini(self) __extension__({ mm_free((self)->slots); })
+
+/**
+ * @brief Get the count of entries in an hash map
+ * @param self the target hash map
+ * @return the count of entries in @p self
+ */
+#define hmap_count(self) ((self)->count)
+
+/**
+ * @brief Get the count of slots of an hash map
+ * @param self the target hash map
+ * @return the count of slots of @p self, either free or not
+ */
+#define hmap_capacity(self) ((self)->slots != NULL ? (self)->mask + 1 : 0)
+
+/**
+ * @brief Get a slot of an hash map
+ * @param self the target hash map
+ * @param i the index of the slot, it must be lower than hmap_capacity()
+ * @return the slot of @p self at index @p i, free if its key is zero
+ */
+#define hmap_slot_at(self, i) ((self)->slots[(i)])
+
+/**
+ * @brief Look up a key in an hash map
+ * @param h the target hash map
+ * @param key the key to look for, it must be non-zero
+ * @param val_p a pointer to the variable which receives the value associated with @p key, if found
+ * @return true if @p key has been found, false otherwise
+ */
+static inline bool hmap_lookup(const struct hmap *h, uint64_t key, uint64_t *val_p)
+{
+	if(unlikely(!h->count))
+		return false;
+
+	for(array_count_t i = hmap_home(h, key);; i = (i + 1) & h->mask) {
+		if(h->slots[i].key == key) {
+			*val_p = h->slots[i].val;
+			return true;
+		}
+		if(!h->slots[i].key)
+			return false;
+	}
+}
+
+extern void hmap_insert(struct hmap *h, uint64_t key, uint64_t val);
+extern bool hmap_remove(struct hmap *h, uint64_t key);
+extern void hmap_remove_at(struct hmap *h, array_count_t i);
@@ -0,0 +1,325 @@
+/**
+ * @file datatypes/ladder.c
+ *
+ * @brief Ladder queue datatype
+ *
+ * This is an implementation of the ladder queue by Tang, Goh and Thng. Messages in the far future are kept unsorted in
+ * the top list. When the near future gets exhausted, they are spread across the buckets of a rung; the first non-empty
+ * bucket of the last rung is then either sorted in the bottom array, from which messages are extracted, or spread
+ * across a finer grained rung if it is too crowded. Messages are always moved around by linking them through their
+ * next field, which is unused while they sit in the private thread queue, so the structure itself never allocates
+ * memory per message.
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#include <datatypes/ladder.h>
+
+#include <math.h>
+#include <stdlib.h>
+
+/**
+ * @brief Compares two messages so that qsort() lays them out by decreasing timestamp
+ * @param a a pointer to the first message pointer
+ * @param b a pointer to the second message pointer
+ * @return a value which is negative if @p a should be placed before @p b, positive if after, zero otherwise
+ */
+static int ladder_msg_cmp(const void *a, const void *b)
+{
+	simtime_t ta = (*(struct lp_msg *const *)a)->dest_t;
+	simtime_t tb = (*(struct lp_msg *const *)b)->dest_t;
+	return (ta < tb) - (ta > tb);
+}
+
+/**
+ * @brief Places a message in the proper bucket of a rung
+ * @param r the rung target of the insertion
+ * @param msg the message to insert, its timestamp must not precede the start of the current bucket of @p r
+ */
+static inline void rung_insert(struct ladder_rung *r, struct lp_msg *msg)
+{
+	simtime_t d = (msg->dest_t - r->start) / r->width;
+	array_count_t i = d < r->n_buckets ? (array_count_t)d : r->n_buckets - 1;
+	// floating point rounding may place the message slightly before the current bucket
+	if(unlikely(i < r->cur))
+		i = r->cur;
+
+	msg->next = r->buckets[i];
+	r->buckets[i] = msg;
+	++r->count;
+}
+
+/**
+ * @brief Spreads a list of messages over a new rung, if it is worth it
+ * @param l the ladder queue
+ * @param list the list of messages, linked through their next field
+ * @param n the count of messages in @p list
+ * @param min the lowest timestamp in @p list
+ * @param max the highest timestamp in @p list
+ * @return true if the new rung has been spawned, false if @p list has been left untouched
+ */
+static bool ladder_rung_spawn(struct ladder *l, struct lp_msg *list, array_count_t n, simtime_t min, simtime_t max)
+{
+	if(n <= LADDER_BUCKET_THRESHOLD || l->n_rungs == LADDER_RUNGS_MAX)
+		return false;
+
+	simtime_t width = (max - min) / n;
+	// the timestamps are too close to be told apart by buckets
+	if(!(min + width > min))
+		return false;
+
+	struct ladder_rung *r = &l->rungs[l->n_rungs++];
+	if(r->capacity <= n) {
+		mm_free(r->buckets);
+		r->capacity = n + 1;
+		r->buckets = mm_alloc(r->capacity * sizeof(*r->buckets));
+	}
+	r->n_buckets = n + 1;
+	memset(r->buckets, 0, r->n_buckets * sizeof(*r->buckets));
+	r->cur = 0;
+	r->count = 0;
+	r->start = min;
+	r->width = width;
+
+	while(list != NULL) {
+		struct lp_msg *next = list->next;
+		rung_insert(r, list);
+		list = next;
+	}
+	return true;
+}
+
+/**
+ * @brief Sorts a list of messages in the bottom array
+ * @param l the ladder queue, whose bottom array must be empty
+ * @param list the list of messages, linked through their next field
+ * @param n the count of messages in @p list
+ */
+static void ladder_bottom_fill(struct ladder *l, struct lp_msg *list, array_count_t n)
+{
+	array_reserve(l->bottom, n);
+	struct lp_msg **items = array_items(l->bottom);
+	for(array_count_t i = 0; i < n; ++i) {
+		items[i] = list;
+		list = list->next;
+	}
+	array_count(l->bottom) = n;
+	qsort(items, n, sizeof(*items), ladder_msg_cmp);
+}
+
+/**
+ * @brief Inserts a message in the bottom array, keeping it sorted
+ * @param l the ladder queue
+ * @param msg the message to insert
+ *
+ * If the bottom array grows too much, its content is moved into a new rung.
+ */
+static void ladder_bottom_insert(struct ladder *l, struct lp_msg *msg)
+{
+	array_count_t lo = 0, hi = array_count(l->bottom);
+	struct lp_msg **items = array_items(l->bottom);
+	while(lo < hi) {
+		array_count_t mid = (lo + hi) / 2;
+		if(items[mid]->dest_t > msg->dest_t)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	array_add_at(l->bottom, lo, msg);
+
+	array_count_t n = array_count(l->bottom);
+	if(likely(n <= LADDER_BUCKET_THRESHOLD * 2))
+		return;
+
+	items = array_items(l->bottom);
+	for(array_count_t i = 1; i < n; ++i)
+		items[i - 1]->next = items[i];
+	items[n - 1]->next = NULL;
+
+	if(ladder_rung_spawn(l, items[0], n, items[n - 1]->dest_t, items[0]->dest_t))
+		array_count(l->bottom) = 0;
+}
+
+/**
+ * @brief Initializes an empty ladder queue
+ * @param l the ladder queue to initialize
+ */
+void ladder_init(struct ladder *l)
+{
+	memset(l, 0, sizeof(*l));
+	l->top_min = INFINITY;
+	l->top_max = -INFINITY;
+	l->top_start = -INFINITY;
+	array_init(l->bottom);
+}
+
+/**
+ * @brief Finalizes a ladder queue
+ * @param l the ladder queue to finalize
+ *
+ * The user is responsible for cleaning up the possibly contained messages, for example by extracting them.
+ */
+void ladder_fini(struct ladder *l)
+{
+	for(unsigned i = 0; i < LADDER_RUNGS_MAX; ++i)
+		mm_free(l->rungs[i].buckets);
+
+	array_fini(l->bottom);
+}
+
+/**
+ * @brief Inserts a message in a ladder queue
+ * @param l the ladder queue target of the insertion
+ * @param msg the message to insert
+ */
+void ladder_insert(struct ladder *l, struct lp_msg *msg)
+{
+	simtime_t t = msg->dest_t;
+	if(t >= l->top_start) {
+		msg->next = l->top;
+		l->top = msg;
+		++l->top_count;
+		l->top_min = t < l->top_min ? t : l->top_min;
+		l->top_max = t > l->top_max ? t : l->top_max;
+		return;
+	}
+
+	for(unsigned i = 0; i < l->n_rungs; ++i) {
+		struct ladder_rung *r = &l->rungs[i];
+		if(t >= r->start + r->cur * r->width) {
+			rung_insert(r, msg);
+			return;
+		}
+	}
+
+	ladder_bottom_insert(l, msg);
+}
+
+/**
+ * @brief Extracts the message with the lowest timestamp from a ladder queue
+ * @param l the ladder queue from where to extract the message
+ * @return the extracted message or NULL if @p l is empty
+ */
+struct lp_msg *ladder_extract(struct ladder *l)
+{
+	if(likely(array_count(l->bottom)))
+		return array_pop(l->bottom);
+
+	while(true) {
+		if(!l->n_rungs) {
+			if(!l->top_count) {
+				l->top_start = -INFINITY;
+				return NULL;
+			}
+
+			struct lp_msg *list = l->top;
+			array_count_t n = l->top_count;
+			simtime_t min = l->top_min, max = l->top_max;
+			l->top = NULL;
+			l->top_count = 0;
+			l->top_min = INFINITY;
+			l->top_max = -INFINITY;
+
+			if(!ladder_rung_spawn(l, list, n, min, max)) {
+				l->top_start = max;
+				ladder_bottom_fill(l, list, n);
+				return array_pop(l->bottom);
+			}
+
+			struct ladder_rung *r = &l->rungs[0];
+			l->top_start = r->start + r->n_buckets * r->width;
+			continue;
+		}
+
+		struct ladder_rung *r = &l->rungs[l->n_rungs - 1];
+		if(!r->count) {
+			--l->n_rungs;
+			continue;
+		}
+
+		while(r->buckets[r->cur] == NULL)
+			++r->cur;
+
+		struct lp_msg *list = r->buckets[r->cur];
+		r->buckets[r->cur++] = NULL;
+
+		array_count_t n = 0;
+		simtime_t min = INFINITY, max = -INFINITY;
+		for(struct lp_msg *m = list; m != NULL; m = m->next) {
+			++n;
+			min = m->dest_t < min ? m->dest_t : min;
+			max = m->dest_t > max ? m->dest_t : max;
+		}
+
+		r->count -= n;
+		if(!r->count)
+			--l->n_rungs;
+
+		if(ladder_rung_spawn(l, list, n, min, max))
+			continue;
+
+		ladder_bottom_fill(l, list, n);
+		return array_pop(l->bottom);
+	}
+}
+
+/**
+ * @brief Unlinks the messages destined to a given LP from a list of messages
+ * @param list_p a pointer to the head of the list, linked through the next field of the messages
+ * @param dest the id of the LP
+ * @param evicted_p a pointer to the head of the list where the unlinked messages are moved
+ * @return the count of unlinked messages
+ */
+static array_count_t ladder_list_evict(struct lp_msg **list_p, lp_id_t dest, struct lp_msg **evicted_p)
+{
+	array_count_t n = 0;
+	while(*list_p != NULL) {
+		struct lp_msg *msg = *list_p;
+		if(msg->dest != dest) {
+			list_p = &msg->next;
+			continue;
+		}
+		*list_p = msg->next;
+		msg->next = *evicted_p;
+		*evicted_p = msg;
+		++n;
+	}
+	return n;
+}
+
+/**
+ * @brief Removes from a ladder queue all the messages destined to a given LP
+ * @param l the ladder queue
+ * @param dest the id of the LP
+ * @return the list of the removed messages, linked through their next field
+ *
+ * The remaining messages are left where they are, so that the cost is linear in the count of messages in @p l.
+ */
+struct lp_msg *ladder_evict(struct ladder *l, lp_id_t dest)
+{
+	struct lp_msg *evicted = NULL;
+	l->top_count -= ladder_list_evict(&l->top, dest, &evicted);
+	if(!l->top_count) {
+		l->top_min = INFINITY;
+		l->top_max = -INFINITY;
+	}
+
+	for(unsigned i = 0; i < l->n_rungs; ++i) {
+		struct ladder_rung *r = &l->rungs[i];
+		for(array_count_t j = r->cur; j < r->n_buckets && r->count; ++j)
+			r->count -= ladder_list_evict(&r->buckets[j], dest, &evicted);
+	}
+
+	array_count_t k = 0;
+	for(array_count_t i = 0; i < array_count(l->bottom); ++i) {
+		struct lp_msg *msg = array_get_at(l->bottom, i);
+		if(msg->dest == dest) {
+			msg->next = evicted;
+			evicted = msg;
+		} else {
+			array_get_at(l->bottom, k++) = msg;
+		}
+	}
+	array_count(l->bottom) = k;
+	return evicted;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file datatypes/ladder.h
+ *
+ * @brief Ladder queue datatype
+ *
+ * A ladder queue for messages, providing amortized O(1) insertions and extractions
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#pragma once
+
+#include <core/core.h>
+#include <datatypes/array.h>
+#include <lp/msg.h>
+
+/// The maximum number of rungs in a ladder queue
+#define LADDER_RUNGS_MAX 8U
+/// The number of messages in a bucket above which a new rung is spawned instead of sorting the bucket
+#define LADDER_BUCKET_THRESHOLD 50U
+
+/// A rung of a ladder queue, an array of equally wide buckets of unsorted messages
+struct ladder_rung {
+	/// The buckets of this rung, each one is a list of messages linked through their next field
+	struct lp_msg **buckets;
+	/// The number of buckets used in this rung
+	array_count_t n_buckets;
+	/// The number of buckets allocated in this rung
+	array_count_t capacity;
+	/// The index of the current bucket, the ones preceding it have already been consumed
+	array_count_t cur;
+	/// The count of messages held in this rung
+	array_count_t count;
+	/// The timestamp at which the first bucket of this rung starts
+	simtime_t start;
+	/// The timestamp interval covered by a single bucket
+	simtime_t width;
+};
+
+/// A ladder queue of messages
+struct ladder {
+	/// The unsorted list of the messages in the far future, linked through their next field
+	struct lp_msg *top;
+	/// The count of messages in the top list
+	array_count_t top_count;
+	/// The number of rungs currently in use
+	unsigned n_rungs;
+	/// The lowest timestamp in the top list
+	simtime_t top_min;
+	/// The highest timestamp in the top list
+	simtime_t top_max;
+	/// The timestamp starting from which a message is placed in the top list
+	simtime_t top_start;
+	/// The rungs of the ladder, the last used one holds the nearest future
+	struct ladder_rung rungs[LADDER_RUNGS_MAX];
+	/// The messages in the nearest future, sorted by decreasing timestamp
+	dyn_array(struct lp_msg *) bottom;
+};
+
+extern void ladder_init(struct ladder *l);
+extern void ladder_fini(struct ladder *l);
+extern void ladder_insert(struct ladder *l, struct lp_msg *msg);
+extern struct lp_msg *ladder_extract(struct ladder *l);
+extern struct lp_msg *ladder_evict(struct ladder *l, lp_id_t dest);
@@ -9,40 +9,391 @@
  * then cheap, while extractions simply empty the buffer into the private queue. This way the critically thread locked
  * code is minimal.
  *
+ * Messages destined to other threads are not published one by one: each thread stages them in a private batch for
+ * each destination thread, which is then published with a single atomic splice when it fills up or when
+ * msg_queue_flush() is called. Messages destined to the current thread go straight into its private queue.
+ *
+ * If the ROOTSIM_SPSC_RINGS macro is defined, each pair of threads is additionally connected by a bounded single
+ * producer single consumer ring, which is tried first; the buffer is used only when the ring is full.
+ *
+ * The private thread queue is a 4-ary heap by default. If the ROOTSIM_LADDER_QUEUE macro is defined, a ladder queue is
+ * used instead, which offers amortized O(1) insertions and extractions at the cost of a less predictable latency. If
+ * the ROOTSIM_LP_QUEUES macro is defined, a two-level scheduler is used: each LP keeps its own heap of pending messages
+ * while the thread heap holds a single entry for each LP with pending messages, keyed by its next timestamp.
+ *
+ * LPs may be moved between threads, see msg_queue_lp_move(). A thread which drains a message destined to an LP it does
+ * not host anymore forwards it to the new host.
+ *
  * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
  * SPDX-License-Identifier: GPL-3.0-only
  */
 #include <datatypes/msg_queue.h>
 
 #include <core/sync.h>
-#include <datatypes/heap.h>
+#include <gvt/gvt.h>
+#include <log/stats.h>
 #include <lp/lp.h>
 #include <mm/msg_allocator.h>
+#include <parallel/balance.h>
 
 #include <stdalign.h>
 #include <stdatomic.h>
 
-/// Determine an ordering between two elements in a queue
-#define q_elem_is_before(ma, mb)  ((ma).t < (mb).t)
+/// The count of messages in a batch above which the batch gets published right away
+#define MSG_BATCH_SIZE 32U
+
+#ifdef ROOTSIM_LADDER_QUEUE
+
+#include <datatypes/ladder.h>
+
+/// The private thread queue
+static __thread struct ladder mqp;
+
+/// Initializes the private thread queue
+#define mqp_init() ladder_init(&mqp)
+/// Finalizes the private thread queue
+#define mqp_fini() ladder_fini(&mqp)
+/// Inserts a message in the private thread queue
+#define mqp_insert(msg) ladder_insert(&mqp, msg)
+/// Extracts the lowest timestamp message from the private thread queue, NULL if empty
+#define mqp_extract() ladder_extract(&mqp)
+/// Returns the lowest timestamp message if it is cheaply known, i.e. if it lies in the bottom, NULL otherwise
+#define mqp_peek() (likely(array_count(mqp.bottom)) ? array_peek(mqp.bottom) : NULL)
+/// Starts a bulk insertion of messages in the private thread queue
+#define mqp_bulk_begin()
+/// Inserts a message in the private thread queue as part of a bulk insertion
+#define mqp_bulk_insert(msg) mqp_insert(msg)
+/// Ends a bulk insertion of messages in the private thread queue
+#define mqp_bulk_end()
+
+/// Removes from the private thread queue the messages destined to an LP, returns them as a list
+#define mqp_lp_evict(lp_id) ladder_evict(&mqp, lp_id)
+/// Removes a message from the private thread queue, not supported by the ladder queue which always returns false
+#define mqp_remove(msg) false
+
+#elif defined(ROOTSIM_LP_QUEUES)
 
-/// An element in the message queue
-struct q_elem {
-	/// The timestamp of the message
+/// An element in the thread level heap of the two-level scheduler
+struct q_lp_elem {
+	/// The timestamp of the next message of the LP
 	simtime_t t;
-	/// The message enqueued
-	struct lp_msg *m;
+	/// The LP with pending messages
+	struct lp_ctx *lp;
 };
 
+/// Keeps track of the position of an LP in the thread level heap
+#define q_lp_elem_pos_set(e, i) ((e).lp->q.pos = (i))
+/// Keeps track of the position of a message in the heap of its LP
+#define q_elem_pos_set(e, i) ((e).m->q_pos = (i))
+
+/// The private thread queue, holding an entry for each LP with pending messages
+static __thread heap_declare(struct q_lp_elem) mqp;
+
+/// Initializes the private thread queue
+#define mqp_init() heap_init(mqp)
+/// Finalizes the private thread queue
+#define mqp_fini() heap_fini(mqp)
+
+/**
+ * @brief Inserts a message in the private thread queue
+ * @param msg the message to insert
+ *
+ * The message is inserted in the queue of its destination LP, whose entry in the thread level heap is added or moved up
+ * if needed.
+ */
+static void mqp_insert(struct lp_msg *msg)
+{
+	struct lp_ctx *lp = &lps[msg->dest];
+	struct q_elem qe = {.t = msg->dest_t, .m = msg};
+	bool was_empty = heap_is_empty(lp->q.msgs);
+	array_push(lp->q.msgs, qe);
+	if(heap_sift_up(lp->q.msgs, q_elem_is_before, q_elem_pos_set, array_count(lp->q.msgs) - 1))
+		return;
+
+	if(was_empty) {
+		struct q_lp_elem le = {.t = qe.t, .lp = lp};
+		array_push(mqp, le);
+		heap_sift_up(mqp, q_elem_is_before, q_lp_elem_pos_set, array_count(mqp) - 1);
+	} else {
+		array_get_at(mqp, lp->q.pos).t = qe.t;
+		heap_sift_up(mqp, q_elem_is_before, q_lp_elem_pos_set, lp->q.pos);
+	}
+}
+
+/**
+ * @brief Extracts the lowest timestamp message from the private thread queue
+ * @return the extracted message or NULL if the queue is empty
+ */
+static struct lp_msg *mqp_extract(void)
+{
+	if(unlikely(heap_is_empty(mqp)))
+		return NULL;
+
+	struct lp_ctx *lp = heap_min(mqp).lp;
+	struct lp_msg *msg = heap_remove_at(lp->q.msgs, q_elem_is_before, q_elem_pos_set, 0).m;
+	if(heap_is_empty(lp->q.msgs)) {
+		heap_remove_at(mqp, q_elem_is_before, q_lp_elem_pos_set, 0);
+	} else {
+		array_get_at(mqp, 0).t = heap_min(lp->q.msgs).t;
+		heap_sift_down(mqp, q_elem_is_before, q_lp_elem_pos_set, 0);
+	}
+	return msg;
+}
+
+/// Returns the lowest timestamp message in the private thread queue, NULL if empty
+#define mqp_peek() (likely(!heap_is_empty(mqp)) ? heap_min(heap_min(mqp).lp->q.msgs).m : NULL)
+
+/**
+ * @brief Removes a message from the private thread queue
+ * @param msg the message to remove, its destination LP must be hosted by the current thread
+ * @return true if the message has been removed, false if it isn't in the private thread queue
+ */
+static bool mqp_remove(struct lp_msg *msg)
+{
+	struct lp_ctx *lp = &lps[msg->dest];
+	array_count_t i = msg->q_pos;
+	if(i >= heap_count(lp->q.msgs) || heap_items(lp->q.msgs)[i].m != msg)
+		return false;
+
+	heap_remove_at(lp->q.msgs, q_elem_is_before, q_elem_pos_set, i);
+	if(heap_is_empty(lp->q.msgs)) {
+		heap_remove_at(mqp, q_elem_is_before, q_lp_elem_pos_set, lp->q.pos);
+	} else if(i == 0) {
+		array_get_at(mqp, lp->q.pos).t = heap_min(lp->q.msgs).t;
+		heap_sift_down(mqp, q_elem_is_before, q_lp_elem_pos_set, lp->q.pos);
+	}
+	return true;
+}
+/// Starts a bulk insertion of messages in the private thread queue
+#define mqp_bulk_begin()
+/// Inserts a message in the private thread queue as part of a bulk insertion
+#define mqp_bulk_insert(msg) mqp_insert(msg)
+/// Ends a bulk insertion of messages in the private thread queue
+#define mqp_bulk_end()
+
+/**
+ * @brief Removes from the private thread queue the messages destined to a given LP
+ * @param lp_id the id of the LP
+ * @return the list of the removed messages, linked through their next field
+ */
+static struct lp_msg *mqp_lp_evict(lp_id_t lp_id)
+{
+	struct lp_ctx *lp = &lps[lp_id];
+	if(heap_is_empty(lp->q.msgs))
+		return NULL;
+
+	heap_remove_at(mqp, q_elem_is_before, q_lp_elem_pos_set, lp->q.pos);
+	struct lp_msg *evicted = NULL;
+	for(array_count_t i = 0; i < heap_count(lp->q.msgs); ++i) {
+		struct lp_msg *msg = heap_items(lp->q.msgs)[i].m;
+		msg->next = evicted;
+		evicted = msg;
+	}
+	array_count(lp->q.msgs) = 0;
+	return evicted;
+}
+
+/**
+ * @brief Initializes the pending messages queue of an LP
+ * @param lp the LP whose queue has to be initialized
+ */
+void msg_queue_lp_init(struct lp_ctx *lp)
+{
+	heap_init(lp->q.msgs);
+}
+
+/**
+ * @brief Finalizes the pending messages queue of an LP, releasing the still pending messages
+ * @param lp the LP whose queue has to be finalized
+ */
+void msg_queue_lp_fini(struct lp_ctx *lp)
+{
+	if(!heap_is_empty(lp->q.msgs)) {
+		heap_remove_at(mqp, q_elem_is_before, q_lp_elem_pos_set, lp->q.pos);
+		for(array_count_t i = 0; i < heap_count(lp->q.msgs); ++i)
+			msg_allocator_free(heap_items(lp->q.msgs)[i].m);
+	}
+	heap_fini(lp->q.msgs);
+}
+
+#else
+
+/// The private thread queue
+static __thread dheap_declare(struct lp_msg *) mqp;
+/// The count of elements in the private thread queue when the current bulk insertion started
+static __thread array_count_t mqp_bulk_start;
+
+/// Keeps track of the position of a message in the private thread queue
+#define msg_q_pos_set(msg, i) ((msg)->q_pos = (i))
+
+/// Initializes the private thread queue
+#define mqp_init() dheap_init(mqp)
+/// Finalizes the private thread queue
+#define mqp_fini() dheap_fini(mqp)
+/// Inserts a message in the private thread queue
+#define mqp_insert(msg) dheap_insert(mqp, dheap_no_tie, msg_q_pos_set, (msg)->dest_t, (msg))
+/// Extracts the lowest timestamp message from the private thread queue, NULL if empty
+#define mqp_extract() (likely(dheap_count(mqp)) ? dheap_extract(mqp, dheap_no_tie, msg_q_pos_set) : NULL)
+/// Returns the lowest timestamp message in the private thread queue, NULL if empty
+#define mqp_peek() (likely(dheap_count(mqp)) ? dheap_min(mqp) : NULL)
+/// Starts a bulk insertion of messages in the private thread queue
+#define mqp_bulk_begin() (mqp_bulk_start = dheap_count(mqp))
+/// Inserts a message in the private thread queue as part of a bulk insertion, the heap is repaired by mqp_bulk_end()
+#define mqp_bulk_insert(msg) dheap_push(mqp, (msg)->dest_t, (msg))
+/// Ends a bulk insertion of messages in the private thread queue
+#define mqp_bulk_end() dheap_heapify_tail(mqp, dheap_no_tie, msg_q_pos_set, dheap_count(mqp) - mqp_bulk_start)
+
+/**
+ * @brief Removes from the private thread queue the messages destined to a given LP
+ * @param lp_id the id of the LP
+ * @return the list of the removed messages, linked through their next field
+ *
+ * The heap is filtered in place and then rebuilt from scratch, which takes linear time.
+ */
+static struct lp_msg *mqp_lp_evict(lp_id_t lp_id)
+{
+	struct lp_msg *evicted = NULL;
+	array_count_t j = 0;
+	for(array_count_t i = 0; i < dheap_count(mqp); ++i) {
+		struct lp_msg *msg = dheap_items(mqp)[i];
+		if(msg->dest == lp_id) {
+			msg->next = evicted;
+			evicted = msg;
+		} else {
+			dheap_keys(mqp)[j] = dheap_keys(mqp)[i];
+			dheap_items(mqp)[j++] = msg;
+		}
+	}
+	dheap_truncate(mqp, j);
+	dheap_heapify_tail(mqp, dheap_no_tie, msg_q_pos_set, j);
+	return evicted;
+}
+
+/**
+ * @brief Removes a message from the private thread queue
+ * @param msg the message to remove, its destination LP must be hosted by the current thread
+ * @return true if the message has been removed, false if it isn't in the private thread queue
+ */
+static bool mqp_remove(struct lp_msg *msg)
+{
+	array_count_t i = msg->q_pos;
+	if(i >= dheap_count(mqp) || dheap_items(mqp)[i] != msg)
+		return false;
+
+	dheap_remove_at(mqp, dheap_no_tie, msg_q_pos_set, i);
+	return true;
+}
+
+#endif
+
 /// The multi-threaded message buffer, implemented as a non-blocking list
 struct msg_buffer {
 	/// The head of the messages list
 	alignas(CACHE_LINE_SIZE) _Atomic(struct lp_msg *) list;
 };
 
+/// A batch of messages staged for another thread, linked through their next field
+struct msg_batch {
+	/// The most recently staged message
+	struct lp_msg *head;
+	/// The least recently staged message
+	struct lp_msg *tail;
+	/// The count of staged messages
+	unsigned count;
+};
+
 /// The buffers vector
 static struct msg_buffer *queues;
-/// The private thread queue
-static __thread heap_declare(struct q_elem) mqp;
+/// The batches of messages staged by the current thread, one for each destination thread
+static __thread struct msg_batch *batches;
+
+/**
+ * @brief Inserts a message drained from the buffers in the thread private queue, as part of a bulk insertion
+ * @param msg the drained message
+ *
+ * If the destination LP has meanwhile been moved to another thread, the message is forwarded to its new host. The
+ * forwarded message is accounted as extracted, so that the GVT algorithm cannot miss it while it is in transit again.
+ */
+static inline void msg_queue_drained_insert(struct lp_msg *msg)
+{
+	if(unlikely(lid_to_rid(msg->dest) != rid)) {
+		gvt_on_msg_extraction(msg->dest_t);
+		msg_queue_insert(msg);
+		return;
+	}
+	balance_on_msg_enqueue(msg);
+	mqp_bulk_insert(msg);
+}
+
+#ifdef ROOTSIM_SPSC_RINGS
+
+/// The count of slots in each ring, must be a power of two
+#define MSG_RING_SIZE 256U
+
+/// A bounded single producer single consumer ring of messages
+struct msg_ring {
+	/// The index of the next slot to read, only written by the consumer
+	alignas(CACHE_LINE_SIZE) _Atomic(uint32_t) head;
+	/// The index of the next slot to write, only written by the producer
+	alignas(CACHE_LINE_SIZE) _Atomic(uint32_t) tail;
+	/// The slots holding the messages
+	alignas(CACHE_LINE_SIZE) struct lp_msg *slots[MSG_RING_SIZE];
+};
+
+/// The rings matrix, the ring from thread s to thread d is at index d * n_threads + s
+static struct msg_ring *rings;
+/// The last known value of the head index of the rings towards the other threads, one for each destination thread
+static __thread uint32_t *rings_head;
+/// The sender thread whose ring will be drained first at the next drain
+static __thread rid_t rings_next;
+
+/**
+ * @brief Pushes a message in the ring towards another thread
+ * @param dest_rid the id of the destination thread
+ * @param msg the message to push
+ * @return true if the message has been pushed, false if the ring is full
+ */
+static inline bool msg_ring_push(rid_t dest_rid, struct lp_msg *msg)
+{
+	struct msg_ring *r = &rings[dest_rid * global_config.n_threads + rid];
+	uint32_t t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+	if(unlikely(t - rings_head[dest_rid] == MSG_RING_SIZE)) {
+		rings_head[dest_rid] = atomic_load_explicit(&r->head, memory_order_acquire);
+		if(t - rings_head[dest_rid] == MSG_RING_SIZE)
+			return false;
+	}
+
+	r->slots[t & (MSG_RING_SIZE - 1)] = msg;
+	atomic_store_explicit(&r->tail, t + 1, memory_order_release);
+	return true;
+}
+
+/**
+ * @brief Moves the messages from the rings towards the current thread into the thread private queue
+ *
+ * This must be called during a bulk insertion in the private queue. The rings are drained in round-robin order,
+ * starting from a different sender thread each time.
+ */
+static inline void msg_rings_drain(void)
+{
+	struct msg_ring *my_rings = &rings[rid * global_config.n_threads];
+	rid_t s = rings_next;
+	for(rid_t k = 0; k < global_config.n_threads; ++k) {
+		struct msg_ring *r = &my_rings[s];
+		uint32_t h = atomic_load_explicit(&r->head, memory_order_relaxed);
+		uint32_t t = atomic_load_explicit(&r->tail, memory_order_acquire);
+		if(h != t) {
+			do {
+				msg_queue_drained_insert(r->slots[h & (MSG_RING_SIZE - 1)]);
+			} while(++h != t);
+			atomic_store_explicit(&r->head, h, memory_order_release);
+		}
+		s = s + 1 == global_config.n_threads ? 0 : s + 1;
+	}
+	rings_next = rings_next + 1 == global_config.n_threads ? 0 : rings_next + 1;
+}
+
+#endif
 
 /**
  * @brief Initializes the message queue at the node level
@@ -50,6 +401,10 @@ static __thread heap_declare(struct q_elem) mqp;
 void msg_queue_global_init(void)
 {
 	queues = mm_aligned_alloc(CACHE_LINE_SIZE, global_config.n_threads * sizeof(*queues));
+#ifdef ROOTSIM_SPSC_RINGS
+	rings = mm_aligned_alloc(CACHE_LINE_SIZE,
+	    (size_t)global_config.n_threads * global_config.n_threads * sizeof(*rings));
+#endif
 }
 
 /**
@@ -57,8 +412,20 @@ void msg_queue_global_init(void)
  */
 void msg_queue_init(void)
 {
-	heap_init(mqp);
+	mqp_init();
 	atomic_store_explicit(&queues[rid].list, NULL, memory_order_relaxed);
+	batches = mm_alloc(global_config.n_threads * sizeof(*batches));
+	memset(batches, 0, global_config.n_threads * sizeof(*batches));
+#ifdef ROOTSIM_SPSC_RINGS
+	for(rid_t i = 0; i < global_config.n_threads; ++i) {
+		struct msg_ring *r = &rings[rid * global_config.n_threads + i];
+		atomic_store_explicit(&r->head, 0, memory_order_relaxed);
+		atomic_store_explicit(&r->tail, 0, memory_order_relaxed);
+	}
+	rings_head = mm_alloc(global_config.n_threads * sizeof(*rings_head));
+	memset(rings_head, 0, global_config.n_threads * sizeof(*rings_head));
+	rings_next = 0;
+#endif
 }
 
 /**
@@ -66,17 +433,38 @@ void msg_queue_init(void)
  */
 void msg_queue_fini(void)
 {
-	for(array_count_t i = 0; i < heap_count(mqp); ++i)
-		msg_allocator_free(heap_items(mqp)[i].m);
+	struct lp_msg *m;
+	while((m = mqp_extract()) != NULL)
+		msg_allocator_free(m);
 
-	heap_fini(mqp);
+	mqp_fini();
 
-	struct lp_msg *m = atomic_load_explicit(&queues[rid].list, memory_order_relaxed);
+	m = atomic_load_explicit(&queues[rid].list, memory_order_relaxed);
 	while(m != NULL) {
 		struct lp_msg *next = m->next;
 		msg_allocator_free(m);
 		m = next;
 	}
+
+	for(rid_t i = 0; i < global_config.n_threads; ++i) {
+		m = batches[i].head;
+		while(m != NULL) {
+			struct lp_msg *next = m->next;
+			msg_allocator_free(m);
+			m = next;
+		}
+	}
+	mm_free(batches);
+
+#ifdef ROOTSIM_SPSC_RINGS
+	for(rid_t i = 0; i < global_config.n_threads; ++i) {
+		struct msg_ring *r = &rings[rid * global_config.n_threads + i];
+		uint32_t t = atomic_load_explicit(&r->tail, memory_order_acquire);
+		for(uint32_t h = atomic_load_explicit(&r->head, memory_order_relaxed); h != t; ++h)
+			msg_allocator_free(r->slots[h & (MSG_RING_SIZE - 1)]);
+	}
+	mm_free(rings_head);
+#endif
 }
 
 /**
@@ -85,19 +473,30 @@ void msg_queue_fini(void)
 void msg_queue_global_fini(void)
 {
 	mm_aligned_free(queues);
+#ifdef ROOTSIM_SPSC_RINGS
+	mm_aligned_free(rings);
+#endif
 }
 
 /**
- * @brief Move the messages from the thread specific list into the thread private queue
+ * @brief Move the messages sent by the other threads into the thread private queue
+ *
+ * The drained messages are inserted all at once, so that the private queue can be repaired in a single pass.
  */
 static inline void msg_queue_insert_queued(void)
 {
+	mqp_bulk_begin();
 	struct lp_msg *m = atomic_exchange_explicit(&queues[rid].list, NULL, memory_order_acquire);
 	while(m != NULL) {
-		struct q_elem qe = {.t = m->dest_t, .m = m};
-		heap_insert(mqp, q_elem_is_before, qe);
-		m = m->next;
+		struct lp_msg *next = m->next;
+		msg_queue_drained_insert(m);
+		m = next;
 	}
+
+#ifdef ROOTSIM_SPSC_RINGS
+	msg_rings_drain();
+#endif
+	mqp_bulk_end();
 }
 
 /**
@@ -110,7 +509,104 @@ static inline void msg_queue_insert_queued(void)
 struct lp_msg *msg_queue_extract(void)
 {
 	msg_queue_insert_queued();
-	return likely(heap_count(mqp)) ? heap_extract(mqp, q_elem_is_before).m : NULL;
+	struct lp_msg *msg = mqp_extract();
+	if(likely(msg))
+		balance_on_msg_dequeue(msg);
+	return msg;
+}
+
+/**
+ * @brief Extracts the next message from the queue, if its timestamp precedes a given bound
+ * @param t_bound the bound on the timestamp of the message to extract
+ * @returns a pointer to the message to be processed or NULL if there isn't one preceding @p t_bound
+ *
+ * A message held back because of the bound is accounted in the GVT computation as if it had been extracted, otherwise
+ * the GVT could never reach it.
+ */
+struct lp_msg *msg_queue_extract_before(simtime_t t_bound)
+{
+	msg_queue_insert_queued();
+	struct lp_msg *msg = mqp_extract();
+	if(unlikely(msg == NULL))
+		return NULL;
+
+	if(msg->dest_t >= t_bound) {
+		gvt_on_msg_extraction(msg->dest_t);
+		mqp_insert(msg);
+		return NULL;
+	}
+
+	balance_on_msg_dequeue(msg);
+	return msg;
+}
+
+/**
+ * @brief Removes a message from the queue, if it is still pending in the private thread queue
+ * @param msg the message to remove, its destination LP must be hosted by the current thread
+ * @return true if the message has been removed, false otherwise
+ *
+ * The messages just sent by other threads and not yet collected are not found, nor are the ones held in a queue
+ * backend which isn't addressable.
+ */
+bool msg_queue_remove(struct lp_msg *msg)
+{
+	if(!mqp_remove(msg))
+		return false;
+
+	balance_on_msg_dequeue(msg);
+	return true;
+}
+
+/**
+ * @brief Extracts the next message from the queue, if it is destined to a given LP before a given time
+ * @param lp_id the id of the LP
+ * @param t_bound the exclusive upper bound on the timestamp of the message
+ * @returns a pointer to the message to be processed or NULL if the next one is not to @p lp_id before @p t_bound
+ *
+ * Unlike msg_queue_extract(), the messages sent by other threads are not collected: this is meant to cheaply continue
+ * the processing of an LP which has just been handed a message by msg_queue_extract().
+ */
+struct lp_msg *msg_queue_extract_lp(lp_id_t lp_id, simtime_t t_bound)
+{
+	struct lp_msg *msg = mqp_peek();
+	if(msg == NULL || msg->dest != lp_id || msg->dest_t >= t_bound)
+		return NULL;
+
+	mqp_extract();
+	balance_on_msg_dequeue(msg);
+	return msg;
+}
+
+/**
+ * @brief Publishes a batch of staged messages in the buffer of its destination thread
+ * @param b the batch to publish, it must contain at least one message
+ * @param dest_rid the id of the destination thread of @p b
+ */
+static void msg_batch_publish(struct msg_batch *b, rid_t dest_rid)
+{
+	_Atomic(struct lp_msg *) *list_p = &queues[dest_rid].list;
+	b->tail->next = atomic_load_explicit(list_p, memory_order_relaxed);
+	while(unlikely(!atomic_compare_exchange_weak_explicit(list_p, &b->tail->next, b->head, memory_order_release,
+	    memory_order_relaxed)))
+		spin_pause();
+
+	stats_take(STATS_MSG_BATCH, 1);
+	stats_take(STATS_MSG_BATCH_SIZE, b->count);
+	b->head = NULL;
+	b->count = 0;
+}
+
+/**
+ * @brief Publishes all the messages staged by the current thread
+ *
+ * This must be called periodically, so that staged messages are eventually delivered. In particular, the GVT algorithm
+ * relies on all the messages sent by a thread being published before it takes part in a GVT phase.
+ */
+void msg_queue_flush(void)
+{
+	for(rid_t i = 0; i < global_config.n_threads; ++i)
+		if(batches[i].count)
+			msg_batch_publish(&batches[i], i);
 }
 
 /**
@@ -119,11 +615,26 @@ struct lp_msg *msg_queue_extract(void)
  */
 void msg_queue_insert(struct lp_msg *msg)
 {
-	_Atomic(struct lp_msg *) *list_p = &queues[lid_to_rid(msg->dest)].list;
-	msg->next = atomic_load_explicit(list_p, memory_order_relaxed);
-	while(unlikely(!atomic_compare_exchange_weak_explicit(list_p, &msg->next, msg, memory_order_release,
-	    memory_order_relaxed)))
-		spin_pause();
+	rid_t dest_rid = lid_to_rid(msg->dest);
+	if(dest_rid == rid) {
+		balance_on_msg_enqueue(msg);
+		mqp_insert(msg);
+		return;
+	}
+
+#ifdef ROOTSIM_SPSC_RINGS
+	if(likely(msg_ring_push(dest_rid, msg)))
+		return;
+#endif
+
+	struct msg_batch *b = &batches[dest_rid];
+	msg->next = b->head;
+	b->head = msg;
+	if(!b->count++)
+		b->tail = msg;
+
+	if(unlikely(b->count >= MSG_BATCH_SIZE))
+		msg_batch_publish(b, dest_rid);
 }
 
 /**
@@ -133,6 +644,33 @@ void msg_queue_insert(struct lp_msg *msg)
 void msg_queue_insert_self(struct lp_msg *msg)
 {
 	assert(lid_to_rid(msg->dest) == rid);
-	struct q_elem qe = {.t = msg->dest_t, .m = msg};
-	heap_insert(mqp, q_elem_is_before, qe);
+	balance_on_msg_enqueue(msg);
+	mqp_insert(msg);
+}
+
+/**
+ * @brief Moves an LP hosted by the current thread to another thread, together with its pending messages
+ * @param lp_id the id of the LP to move
+ * @param dest_rid the id of the thread which will host the LP
+ * @return the count of moved messages
+ *
+ * The messages are staged as any other message destined to another thread, so they are delivered at the latest with
+ * the next msg_queue_flush() call. The current thread must not touch the LP context after this call.
+ */
+array_count_t msg_queue_lp_move(lp_id_t lp_id, rid_t dest_rid)
+{
+	struct lp_msg *msg = mqp_lp_evict(lp_id);
+	// the messages are accounted again by the new host when they get in its queue
+	balance_load -= lps[lp_id].load;
+	lps[lp_id].load = 0;
+	lp_owner_set(lp_id, dest_rid);
+
+	array_count_t n = 0;
+	while(msg != NULL) {
+		struct lp_msg *next = msg->next;
+		msg_queue_insert(msg);
+		msg = next;
+		++n;
+	}
+	return n;
 }
@@ -11,12 +11,50 @@
 #pragma once
 
 #include <core/core.h>
+#include <datatypes/heap.h>
 #include <lp/msg.h>
 
+/// Determine an ordering between two elements in a queue
+#define q_elem_is_before(ma, mb) ((ma).t < (mb).t)
+
+/// An element in the message queue
+struct q_elem {
+	/// The timestamp of the message
+	simtime_t t;
+	/// The message enqueued
+	struct lp_msg *m;
+};
+
+#ifdef ROOTSIM_LP_QUEUES
+
+/// The pending messages of an LP, used by the two-level scheduler
+struct msg_queue_lp {
+	/// The heap of the pending messages of the LP
+	heap_declare(struct q_elem) msgs;
+	/// The position of the LP in the thread level heap, meaningful only if the LP has pending messages
+	array_count_t pos;
+};
+
+struct lp_ctx;
+extern void msg_queue_lp_init(struct lp_ctx *lp);
+extern void msg_queue_lp_fini(struct lp_ctx *lp);
+
+#else
+
+#define msg_queue_lp_init(lp)
+#define msg_queue_lp_fini(lp)
+
+#endif
+
 extern void msg_queue_global_init(void);
 extern void msg_queue_global_fini(void);
 extern void msg_queue_init(void);
 extern void msg_queue_fini(void);
 extern struct lp_msg *msg_queue_extract(void);
+extern struct lp_msg *msg_queue_extract_lp(lp_id_t lp_id, simtime_t t_bound);
+extern struct lp_msg *msg_queue_extract_before(simtime_t t_bound);
+extern bool msg_queue_remove(struct lp_msg *msg);
 extern void msg_queue_insert(struct lp_msg *msg);
 extern void msg_queue_insert_self(struct lp_msg *msg);
+extern void msg_queue_flush(void);
+extern array_count_t msg_queue_lp_move(lp_id_t lp_id, rid_t dest_rid);
@@ -119,21 +119,45 @@ void mpi_remote_msg_send(struct lp_msg *msg, nid_t dest_nid)
 
 /**
  * @brief Sends a model anti-message to a LP residing on another node
- * @param msg the message to rollback
+ * @param msgs the messages to rollback, all addressed to the same LP
+ * @param n the count of messages in @p msgs
  * @param dest_nid the id of the node where the targeted LP resides
  *
  * This function also calls the relevant handlers in order to keep, for example, the non blocking gvt algorithm running.
  * Note that when this function returns, the anti-message may have not been sent yet. We don't need to actively check
  * for sending completion: the platform, during the fossil collection, leverages the gvt to make sure the message has
  * been indeed sent and processed before freeing it.
+ *
+ * Multiple messages are cancelled by a single coalesced anti-message, which lists the identities of the messages
+ * following the first one in its payload. The messages must be grouped by destination LP, each group led by its
+ * earliest message: the receiver splits the coalesced anti-message along the groups, see remote_anti_msg_insert().
  */
-void mpi_remote_anti_msg_send(struct lp_msg *msg, nid_t dest_nid)
+void mpi_remote_anti_msg_send(struct lp_msg *const msgs[], array_count_t n, nid_t dest_nid)
 {
+	struct lp_msg *msg = msgs[0];
+	int size = msg_remote_anti_size();
+	if(unlikely(n > 1)) {
+		struct lp_msg *c_msg = msg_allocator_alloc((n - 1) * sizeof(struct msg_remote_id));
+		memcpy(msg_remote_data(c_msg), msg_remote_data(msg), msg_remote_anti_size());
+		c_msg->m_type = 0;
+		for(array_count_t i = 1; i < n; ++i) {
+			struct msg_remote_id id = {.dest = msgs[i]->dest,
+			    .dest_t = msgs[i]->dest_t,
+			    .raw_flags = msgs[i]->raw_flags,
+			    .m_seq = msgs[i]->m_seq};
+			memcpy(c_msg->pl + (i - 1) * sizeof(id), &id, sizeof(id));
+		}
+		msg = c_msg;
+		size = msg_remote_size(c_msg);
+	}
+
 	gvt_remote_anti_msg_send(msg, dest_nid);
 
 	MPI_Request req;
-	MPI_Isend(msg_remote_data(msg), msg_remote_anti_size(), MPI_BYTE, dest_nid, RS_MSG_TAG, MPI_COMM_WORLD, &req);
+	MPI_Isend(msg_remote_data(msg), size, MPI_BYTE, dest_nid, RS_MSG_TAG, MPI_COMM_WORLD, &req);
 	MPI_Request_free(&req);
+	if(unlikely(n > 1))
+		msg_allocator_free_at_gvt(msg);
 }
 
 /**
@@ -160,6 +184,46 @@ void mpi_control_msg_send_to(enum msg_ctrl_code ctrl, nid_t dest)
 	MPI_Request_free(&req);
 }
 
+/**
+ * @brief Inserts a remote anti-message in the queue, splitting it if it is a coalesced one
+ * @param msg the remote anti-message, already registered in the GVT subsystem
+ *
+ * The identities listed by a coalesced anti-message are grouped by destination LP, the ones destined to the LP of the
+ * anti-message itself come first. Every other group is handed over to its LP as a new anti-message, led by the first
+ * identity of the group, which is the earliest one: this way the GVT can't pass the messages to annihilate.
+ */
+static void remote_anti_msg_insert(struct lp_msg *msg)
+{
+	array_count_t n = msg->pl_size / sizeof(struct msg_remote_id), i = 0;
+	struct msg_remote_id id;
+	while(i < n) {
+		memcpy(&id, msg->pl + i * sizeof(id), sizeof(id));
+		if(id.dest != msg->dest)
+			break;
+		++i;
+	}
+
+	for(array_count_t j; i < n; i = j) {
+		memcpy(&id, msg->pl + i * sizeof(id), sizeof(id));
+		for(j = i + 1; j < n; ++j) {
+			struct msg_remote_id next;
+			memcpy(&next, msg->pl + j * sizeof(next), sizeof(next));
+			if(next.dest != id.dest)
+				break;
+		}
+
+		struct lp_msg *a_msg = msg_allocator_alloc((j - i - 1) * sizeof(id));
+		a_msg->dest = id.dest;
+		a_msg->dest_t = id.dest_t;
+		a_msg->raw_flags = (id.raw_flags & ~((uint32_t)3U)) | MSG_FLAG_ANTI;
+		a_msg->m_seq = id.m_seq;
+		a_msg->m_type = 0;
+		memcpy(a_msg->pl, msg->pl + (i + 1) * sizeof(id), a_msg->pl_size);
+		msg_queue_insert(a_msg);
+	}
+	msg_queue_insert(msg);
+}
+
 /**
  * @brief Empties the queue of incoming MPI messages, doing the right thing for
  *        each one of them.
@@ -191,16 +255,19 @@ void mpi_remote_msg_handle(void)
 				continue;
 			}
 			msg = msg_allocator_alloc(0);
-			MPI_Mrecv(msg_remote_data(msg), size, MPI_BYTE, &mpi_msg, MPI_STATUS_IGNORE);
-
-			gvt_remote_anti_msg_receive(msg);
 		} else {
 			msg = msg_allocator_alloc(size - offsetof(struct lp_msg, pl) + msg_preamble_size());
-			MPI_Mrecv(msg_remote_data(msg), size, MPI_BYTE, &mpi_msg, MPI_STATUS_IGNORE);
+		}
+		MPI_Mrecv(msg_remote_data(msg), size, MPI_BYTE, &mpi_msg, MPI_STATUS_IGNORE);
 
+		// coalesced anti-messages come with a payload, like the regular messages
+		if(unlikely(gvt_remote_msg_is_anti(msg))) {
+			gvt_remote_anti_msg_receive(msg);
+			remote_anti_msg_insert(msg);
+		} else {
 			gvt_remote_msg_receive(msg);
+			msg_queue_insert(msg);
 		}
-		msg_queue_insert(msg);
 	}
 }
 
@@ -241,7 +308,7 @@ void mpi_remote_msg_drain(void)
 		}
 		MPI_Mrecv(msg_remote_data(msg), size, MPI_BYTE, &mpi_msg, MPI_STATUS_IGNORE);
 
-		if(size == msg_remote_anti_size())
+		if(gvt_remote_msg_is_anti(msg))
 			gvt_remote_anti_msg_receive(msg);
 		else
 			gvt_remote_msg_receive(msg);
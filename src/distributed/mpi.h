@@ -22,7 +22,7 @@ extern void mpi_global_init(int *argc_p, char ***argv_p);
 extern void mpi_global_fini(void);
 
 extern void mpi_remote_msg_send(struct lp_msg *msg, nid_t dest_nid);
-extern void mpi_remote_anti_msg_send(struct lp_msg *msg, nid_t dest_nid);
+extern void mpi_remote_anti_msg_send(struct lp_msg *const msgs[], array_count_t n, nid_t dest_nid);
 
 extern void mpi_control_msg_broadcast(enum msg_ctrl_code ctrl);
 extern void mpi_control_msg_send_to(enum msg_ctrl_code ctrl, nid_t dest);
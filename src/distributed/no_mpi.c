@@ -34,9 +34,10 @@ void mpi_remote_msg_send(struct lp_msg *msg, nid_t dest_nid)
 	__builtin_unreachable();
 }
 
-void mpi_remote_anti_msg_send(struct lp_msg *msg, nid_t dest_nid)
+void mpi_remote_anti_msg_send(struct lp_msg *const msgs[], array_count_t n, nid_t dest_nid)
 {
-	(void)msg;
+	(void)msgs;
+	(void)n;
 	(void)dest_nid;
 	assert(0);
 	__builtin_unreachable();
@@ -25,6 +25,27 @@ void fossil_on_gvt(simtime_t this_gvt)
 	fossil_gvt_current = this_gvt;
 }
 
+/**
+ * @brief Reclaim the early remote anti-messages which the GVT has passed
+ * @param proc_p the message processing data of the LP
+ * @param gvt the current GVT
+ *
+ * The original counterpart of such anti-messages can't be delivered anymore.
+ */
+static void fossil_early_antis_collect(struct process_ctx *proc_p, simtime_t gvt)
+{
+	struct hmap *h = &proc_p->early_antis;
+	for(array_count_t i = 0; i < hmap_capacity(h);) {
+		struct lp_msg *a_msg = (struct lp_msg *)(uintptr_t)hmap_slot_at(h, i).val;
+		if(!hmap_slot_at(h, i).key || a_msg->dest_t >= gvt) {
+			++i;
+			continue;
+		}
+		hmap_remove_at(h, i);
+		msg_allocator_free(a_msg);
+	}
+}
+
 /**
  * @brief Perform fossil collection for the data structures of a certain LP
  * @param lp The LP on which to perform fossil collection
@@ -32,12 +53,15 @@ void fossil_on_gvt(simtime_t this_gvt)
 void fossil_lp_collect(struct lp_ctx *lp)
 {
 	struct process_ctx *proc_p = &lp->p;
+	simtime_t gvt = fossil_gvt_current;
+
+	if(unlikely(hmap_count(&proc_p->early_antis)))
+		fossil_early_antis_collect(proc_p, gvt);
 
 	array_count_t past_i = array_count(proc_p->p_msgs);
 	if(past_i == 0)
 		return;
 
-	simtime_t gvt = fossil_gvt_current;
 	for(const struct lp_msg *msg = array_get_at(proc_p->p_msgs, --past_i); msg->dest_t >= gvt;) {
 		do {
 			if(!past_i)
@@ -46,15 +70,33 @@ void fossil_lp_collect(struct lp_ctx *lp)
 		} while(!is_msg_past(msg));
 	}
 
-	past_i = model_allocator_fossil_lp_collect(&lp->mm_state, past_i + 1);
+	// with the reverse computation no checkpoint is needed, so every message preceding the GVT can go
+	if(global_config.reverse_dispatcher == NULL)
+		past_i = model_allocator_fossil_lp_collect(&lp->mm_state, past_i + 1);
+	else
+		past_i += 1;
 
-	array_count_t k = past_i;
+	array_count_t k = past_i, past_n = 0;
 	while(k--) {
 		struct lp_msg *msg = array_get_at(proc_p->p_msgs, k);
+		if(is_msg_past(msg)) {
+			process_index_remove(proc_p, msg);
+			++past_n;
+		}
 		if(!is_msg_local_sent(msg))
 			msg_allocator_free(unmark_msg(msg));
 	}
 	array_truncate_first(proc_p->p_msgs, past_i);
+	proc_p->p_base += past_i;
+
+	if(global_config.reverse_dispatcher != NULL) {
+		// the bits logged by the first kept message onwards are still needed
+		array_truncate_first(proc_p->r_marks, past_n);
+		uint64_t pos = bitlog_end(&proc_p->r_log);
+		if(!array_is_empty(proc_p->r_marks))
+			pos = array_get_at(proc_p->r_marks, 0);
+		bitlog_discard(&proc_p->r_log, pos);
+	}
 
 	lp->fossil_epoch = fossil_epoch_current;
 }
@@ -132,6 +132,15 @@ void gvt_on_msg_extraction(simtime_t msg_t)
 		gvt_accumulator = msg_t;
 }
 
+/**
+ * @brief Checks whether the current thread is taking part in a GVT computation
+ * @return true if the current thread is not taking part in a GVT computation, false otherwise
+ */
+bool gvt_is_idle(void)
+{
+	return thread_phase == thread_phase_idle;
+}
+
 static inline simtime_t gvt_node_reduce(void)
 {
 	unsigned i = global_config.n_threads - 1;
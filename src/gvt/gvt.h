@@ -14,6 +14,7 @@
 extern void gvt_global_init(void);
 extern simtime_t gvt_phase_run(void);
 extern void gvt_on_msg_extraction(simtime_t msg_t);
+extern bool gvt_is_idle(void);
 
 extern __thread _Bool gvt_phase;
 extern __thread uint32_t remote_msg_seq[2][MAX_NODES];
@@ -42,9 +43,15 @@ static inline void gvt_remote_msg_send(struct lp_msg *msg, nid_t dest_nid)
 static inline void gvt_remote_anti_msg_send(struct lp_msg *msg, nid_t dest_nid)
 {
 	++remote_msg_seq[gvt_phase][dest_nid];
-	msg->raw_flags |= gvt_phase << 1U;
+	msg->raw_flags = (msg->raw_flags & ~((uint32_t)3U)) | 2U | gvt_phase;
 }
 
+/**
+ * Checks if an incoming remote message, not yet registered in the GVT subsystem, is an anti-message
+ * @param msg the remote message to check
+ */
+#define gvt_remote_msg_is_anti(msg) ((msg)->raw_flags & 2U)
+
 /**
  * Registers an incoming remote message in the GVT subsystem
  * @param msg the remote message to register
@@ -61,7 +68,7 @@ static inline void gvt_remote_msg_receive(struct lp_msg *msg)
  */
 static inline void gvt_remote_anti_msg_receive(struct lp_msg *msg)
 {
-	++remote_msg_received[(msg->raw_flags >> 1U) & 1U];
+	++remote_msg_received[msg->raw_flags & 1U];
 	msg->raw_flags &= ~((uint32_t)3U);
 	msg->raw_flags |= MSG_FLAG_ANTI;
 }
@@ -106,3 +106,36 @@ void termination_on_lp_rollback(struct lp_ctx *lp, simtime_t msg_time)
 	lp->termination_t = keep * old_t;
 	lps_to_end += !keep;
 }
+
+/**
+ * @brief Removes an LP from the termination bookkeeping of the current thread, before moving it to another thread
+ * @param lp the LP being moved away
+ *
+ * The maximum termination time of the current thread is left untouched, which is conservative.
+ */
+void termination_lp_leave(struct lp_ctx *lp)
+{
+	lps_to_end -= !lp->termination_t;
+}
+
+/**
+ * @brief Adds an LP to the termination bookkeeping of the current thread, after it has been moved from another thread
+ * @param lp the LP moved to the current thread, which must not have processed messages since termination_lp_leave()
+ */
+void termination_lp_join(struct lp_ctx *lp)
+{
+	lps_to_end += !lp->termination_t;
+	if(lp->termination_t != SIMTIME_MAX)
+		max_t = max(lp->termination_t, max_t);
+}
+
+/**
+ * @brief Checks whether the current thread has already agreed to end the simulation
+ * @return true if the current thread has agreed to end the simulation, false otherwise
+ *
+ * A thread which agreed to end the simulation must not take charge of further LPs.
+ */
+bool termination_thread_ended(void)
+{
+	return max_t == SIMTIME_MAX;
+}
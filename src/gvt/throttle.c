@@ -0,0 +1,101 @@
+/**
+ * @file gvt/throttle.c
+ *
+ * @brief Optimism control module
+ *
+ * The module which bounds how far beyond the GVT the threads can process messages. In the conservative mode, the bound
+ * is the GVT plus the lookahead declared by the model, below which messages are safe, i.e. they can't be rolled back
+ * anymore. With the hybrid synchronization the safe bound is still tracked, but it doesn't bound the threads, which
+ * process optimistically the messages past it. With the optimism throttling, the bound is a window above the GVT,
+ * which each thread narrows when too many of its messages are rolled back and widens again when the rollbacks become
+ * rare. The width of the window is measured in average GVT advancements, so that it follows the pace of the simulation
+ * whatever the time scale of the model.
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#include <gvt/throttle.h>
+
+#include <log/stats.h>
+
+/// The fraction of rolled back messages above which the optimism window is narrowed
+#define THROTTLE_BAD_HIGH 0.25
+/// The fraction of rolled back messages below which the optimism window is widened
+#define THROTTLE_BAD_LOW 0.05
+/// The width of the optimism window when it is first set, in average GVT advancements
+#define THROTTLE_WIDTH_INIT 64.0
+/// The minimum width of the optimism window, in average GVT advancements
+#define THROTTLE_WIDTH_MIN 1.0
+/// The maximum width of the optimism window, in average GVT advancements, beyond which the window is removed
+#define THROTTLE_WIDTH_MAX 1024.0
+
+__thread simtime_t throttle_bound;
+__thread simtime_t throttle_safe_bound;
+
+static __thread struct {
+	/// The last GVT value
+	simtime_t gvt;
+	/// The exponential moving average of the GVT advancements
+	simtime_t gvt_advance;
+	/// The width of the optimism window in average GVT advancements, zero if the window is removed
+	double width;
+} throttle;
+
+/**
+ * @brief Initialize the optimism control module for the current thread
+ */
+void throttle_init(void)
+{
+	throttle.gvt = 0.0;
+	throttle.gvt_advance = 0.0;
+	throttle.width = 0.0;
+	throttle_safe_bound = global_config.lookahead;
+	bool conservative = global_config.lookahead > 0.0 && !global_config.hybrid_synchronization;
+	throttle_bound = conservative ? throttle_safe_bound : SIMTIME_MAX;
+}
+
+/**
+ * @brief Move and tune the optimism window of the current thread
+ * @param gvt the freshly computed GVT value
+ *
+ * This function should be called only at the end of GVT reductions, because the used statistics values are
+ * representative only in that moment.
+ */
+void throttle_on_gvt(simtime_t gvt)
+{
+	if(global_config.lookahead > 0.0) {
+		throttle_safe_bound = gvt + global_config.lookahead;
+		if(!global_config.hybrid_synchronization) {
+			throttle_bound = throttle_safe_bound;
+			return;
+		}
+	}
+
+	if(likely(!global_config.optimism_throttling))
+		return;
+
+	if(likely(gvt > throttle.gvt && gvt != SIMTIME_MAX)) {
+		simtime_t advance = gvt - throttle.gvt;
+		if(throttle.gvt_advance > 0.0)
+			advance = (throttle.gvt_advance * 7.0 + advance) / 8.0;
+		throttle.gvt_advance = advance;
+		throttle.gvt = gvt;
+	}
+
+	uint64_t processed = stats_retrieve(STATS_MSG_PROCESSED);
+	uint64_t rolled_back = stats_retrieve(STATS_MSG_ROLLBACK);
+	if(rolled_back > processed * THROTTLE_BAD_HIGH) {
+		if(throttle.width > 0.0)
+			throttle.width = max(throttle.width / 2.0, THROTTLE_WIDTH_MIN);
+		else
+			throttle.width = THROTTLE_WIDTH_INIT;
+	} else if(rolled_back < processed * THROTTLE_BAD_LOW && throttle.width > 0.0) {
+		throttle.width *= 2.0;
+		if(throttle.width > THROTTLE_WIDTH_MAX)
+			throttle.width = 0.0;
+	}
+
+	bool bounded = throttle.width > 0.0 && throttle.gvt_advance > 0.0;
+	throttle_bound = bounded ? gvt + throttle.width * throttle.gvt_advance : SIMTIME_MAX;
+	stats_take(STATS_OPTIMISM_WINDOW, bounded ? (uint64_t)throttle.width : 0);
+}
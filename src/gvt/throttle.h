@@ -0,0 +1,21 @@
+/**
+ * @file gvt/throttle.h
+ *
+ * @brief Optimism control module
+ *
+ * The module which bounds how far beyond the GVT the threads can process messages
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#pragma once
+
+#include <core/core.h>
+
+/// The bound on the timestamps of the messages which the current thread can process, SIMTIME_MAX if unbounded
+extern __thread simtime_t throttle_bound;
+/// The bound on the timestamps of the safe messages, which can't be rolled back anymore, zero without a lookahead
+extern __thread simtime_t throttle_safe_bound;
+
+extern void throttle_init(void);
+extern void throttle_on_gvt(simtime_t gvt);
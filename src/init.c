@@ -63,10 +63,32 @@ static void print_config(void)
 			fprintf(stderr, "Parallelism: %u threads\n", global_config.n_threads);
 	}
 	fprintf(stderr, "Thread-to-core binding: %s\n", global_config.core_binding ? "enabled" : "disabled");
+	fprintf(stderr, "Work stealing: %s\n", global_config.work_stealing ? "enabled" : "disabled");
+	if(global_config.rebalance_period)
+		fprintf(stderr, "LP rebalancing: every %u GVT computations\n", global_config.rebalance_period);
+	else
+		fprintf(stderr, "LP rebalancing: disabled\n");
+	fprintf(stderr, "Lazy cancellation: %s\n", global_config.lazy_cancellation ? "enabled" : "disabled");
+	if(global_config.lookahead > 0.0 && global_config.hybrid_synchronization)
+		fprintf(stderr, "Synchronization: hybrid, lookahead %lf, %s optimism throttling\n",
+		    global_config.lookahead, global_config.optimism_throttling ? "with" : "without");
+	else if(global_config.lookahead > 0.0)
+		fprintf(stderr, "Synchronization: conservative, lookahead %lf\n", global_config.lookahead);
+	else
+		fprintf(stderr, "Synchronization: optimistic, %s optimism throttling\n",
+		    global_config.optimism_throttling ? "with" : "without");
+	if(global_config.placement_file != NULL)
+		fprintf(stderr, "LP placement: read from %s\n", global_config.placement_file);
+	else
+		fprintf(stderr, "LP placement: %s\n", global_config.placement != NULL ? "custom" : "contiguous blocks");
 
 	fprintf(stderr, "GVT period: %u ms\n", global_config.gvt_period / 1000);
 
-	if(global_config.ckpt_interval) {
+	if(global_config.lookahead > 0.0 && !global_config.hybrid_synchronization && !global_config.serial) {
+		fprintf(stderr, "Checkpoint interval: none, conservative synchronization\n");
+	} else if(global_config.reverse_dispatcher != NULL && !global_config.serial) {
+		fprintf(stderr, "Checkpoint interval: none, reverse computation\n");
+	} else if(global_config.ckpt_interval) {
 		fprintf(stderr, "Checkpoint interval: %u events\n", global_config.ckpt_interval);
 	} else {
 		if(!global_config.serial)
@@ -108,6 +130,21 @@ int RootsimInit(const struct simulation_configuration *conf)
 		return -1;
 	}
 
+	if(unlikely(global_config.lookahead < 0.0)) {
+		fprintf(stderr, "The lookahead can't be negative\n");
+		return -1;
+	}
+
+	if(unlikely(global_config.hybrid_synchronization && global_config.lookahead == 0.0)) {
+		fprintf(stderr, "The hybrid synchronization needs a lookahead\n");
+		return -1;
+	}
+
+	if(unlikely(global_config.work_stealing && global_config.rebalance_period)) {
+		fprintf(stderr, "Work stealing and periodic LP rebalancing can't be enabled together\n");
+		return -1;
+	}
+
 	log_init(global_config.logfile);
 
 	if (global_config.serial)
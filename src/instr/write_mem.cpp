@@ -0,0 +1,207 @@
+/**
+ * @file instr/write_mem.cpp
+ *
+ * @brief LLVM pass reporting the model writes for the incremental checkpoints
+ *
+ * This pass plugin prepends the inline code of __write_mem() to every instruction which writes memory in a model
+ * translation unit, so that the buddy system allocator can keep track of the dirty chunks of the LP memory. A write
+ * within a chunk of the last LP memory buffer hit in the thread is marked in place, the others call the out-of-line
+ * __write_mem_slow(). It is loaded in clang with -fpass-plugin=, or in opt with -load-pass-plugin= and
+ * -passes=rootsim-write-mem.
+ *
+ * Only the code compiled with the pass is instrumented: the writes to the LP memory made by library functions, such as
+ * strcpy(), snprintf(), fread() or a memcpy() not lowered to an intrinsic, are not tracked and must be reported with
+ * __write_mem() by the model itself.
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/PassManager.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Passes/PassPlugin.h>
+#include <llvm/Transforms/Utils/BasicBlockUtils.h>
+
+using namespace llvm;
+
+namespace {
+
+/// The name of the function which marks the written memory as dirty
+const char *const write_mem_name = "__write_mem";
+/// The name of the out-of-line slow path of __write_mem()
+const char *const write_mem_slow_name = "__write_mem_slow";
+/// The name of the thread-local cache of the last LP memory buffer hit, a struct rs_write_cache
+const char *const write_cache_name = "__write_mem_cache";
+/// The size exponent of the tracked memory chunks, RS_WRITE_CHUNK_EXP in ROOT-Sim.h
+const unsigned write_chunk_exp = 6;
+
+/**
+ * @brief Check if a pointer is loaded from the write cache
+ * @param obj the underlying object of a pointer
+ * @return true if @p obj is a load from __write_mem_cache, false otherwise
+ *
+ * The writes to the dirty bitmaps, made by __write_mem() when inlined in the model code, must not be tracked in turn.
+ */
+bool is_write_cache_load(const Value *obj)
+{
+	const auto *l = dyn_cast<LoadInst>(obj);
+	if(l == nullptr)
+		return false;
+
+	obj = getUnderlyingObject(l->getPointerOperand());
+#if LLVM_VERSION_MAJOR >= 16
+	if(const auto *ii = dyn_cast<IntrinsicInst>(obj))
+		if(ii->getIntrinsicID() == Intrinsic::threadlocal_address)
+			obj = ii->getArgOperand(0);
+#endif
+	return obj->getName() == write_cache_name;
+}
+
+/**
+ * @brief Check if a write can't possibly hit the LP memory
+ * @param ptr the written address
+ * @return true if @p ptr is derived from a stack slot or a global variable, false otherwise
+ *
+ * The LP memory is only served by the buddy system allocator, so these writes need no tracking.
+ */
+bool is_write_untracked(const Value *ptr)
+{
+	const Value *obj = getUnderlyingObject(ptr);
+	return isa<AllocaInst>(obj) || isa<GlobalVariable>(obj) || is_write_cache_load(obj);
+}
+
+/// The pass instrumenting the writes to memory
+struct WriteMemPass : PassInfoMixin<WriteMemPass> {
+	PreservedAnalyses run(Function &f, FunctionAnalysisManager &)
+	{
+		if(f.isDeclaration() || f.getName() == write_mem_name)
+			return PreservedAnalyses::all();
+
+		Module &m = *f.getParent();
+		const DataLayout &dl = m.getDataLayout();
+		LLVMContext &ctx = m.getContext();
+		Type *size_ty = dl.getIntPtrType(ctx);
+#if LLVM_VERSION_MAJOR >= 17
+		Type *ptr_ty = PointerType::getUnqual(ctx);
+#else
+		Type *ptr_ty = Type::getInt8PtrTy(ctx);
+#endif
+		Type *byte_ty = Type::getInt8Ty(ctx);
+		FunctionCallee write_mem_slow = m.getOrInsertFunction(write_mem_slow_name, Type::getVoidTy(ctx), ptr_ty,
+		    size_ty);
+		// the base, the size and the dirty bitmap of the cached buffer
+		StructType *cache_ty = StructType::get(ctx, {ptr_ty, size_ty, ptr_ty});
+		Constant *cache_var = m.getOrInsertGlobal(write_cache_name, cache_ty, [&] {
+			return new GlobalVariable(m, cache_ty, false, GlobalValue::ExternalLinkage, nullptr,
+			    write_cache_name, nullptr, GlobalValue::GeneralDynamicTLSModel);
+		});
+		MDNode *fast_likely = MDBuilder(ctx).createBranchWeights(2000, 1);
+
+		// the instrumentation is collected first, to avoid altering the instructions while iterating over them
+		SmallVector<std::pair<Instruction *, std::pair<Value *, Value *>>, 16> writes;
+		for(Instruction &i : instructions(f)) {
+			Value *ptr = nullptr, *size = nullptr;
+			if(auto *s = dyn_cast<StoreInst>(&i)) {
+				ptr = s->getPointerOperand();
+				size = ConstantInt::get(size_ty, dl.getTypeStoreSize(s->getValueOperand()->getType()));
+			} else if(auto *r = dyn_cast<AtomicRMWInst>(&i)) {
+				ptr = r->getPointerOperand();
+				size = ConstantInt::get(size_ty, dl.getTypeStoreSize(r->getValOperand()->getType()));
+			} else if(auto *x = dyn_cast<AtomicCmpXchgInst>(&i)) {
+				ptr = x->getPointerOperand();
+				size = ConstantInt::get(size_ty, dl.getTypeStoreSize(x->getNewValOperand()->getType()));
+			} else if(auto *mi = dyn_cast<MemIntrinsic>(&i)) {
+				ptr = mi->getDest();
+				size = mi->getLength();
+			} else {
+				continue;
+			}
+
+			if(ptr->getType()->getPointerAddressSpace() || is_write_untracked(ptr))
+				continue;
+
+			writes.push_back({&i, {ptr, size}});
+		}
+
+		if(writes.empty())
+			return PreservedAnalyses::all();
+
+		for(auto &w : writes) {
+			IRBuilder<> b(w.first);
+			Value *ptr = b.CreatePointerCast(w.second.first, ptr_ty);
+			Value *size = b.CreateZExtOrTrunc(w.second.second, size_ty);
+#if LLVM_VERSION_MAJOR >= 16
+			Value *cache = b.CreateThreadLocalAddress(cache_var);
+#else
+			Value *cache = cache_var;
+#endif
+			cache = b.CreatePointerCast(cache, PointerType::getUnqual(cache_ty));
+
+			// the same checks of __write_mem(): the write must not leave the chunk in the cached buffer
+			Value *base = b.CreateLoad(ptr_ty, b.CreateStructGEP(cache_ty, cache, 0));
+			Value *off = b.CreateSub(b.CreatePtrToInt(ptr, size_ty), b.CreatePtrToInt(base, size_ty));
+			Value *last = b.CreateSub(b.CreateAdd(off, size), ConstantInt::get(size_ty, 1));
+			Value *buf_size = b.CreateLoad(size_ty, b.CreateStructGEP(cache_ty, cache, 1));
+			Value *in_buf = b.CreateICmpULT(last, buf_size);
+			Value *in_chunk = b.CreateICmpEQ(b.CreateLShr(b.CreateXor(off, last), write_chunk_exp),
+			    ConstantInt::get(size_ty, 0));
+
+			Instruction *fast, *slow;
+			Value *hit = b.CreateAnd(in_buf, in_chunk);
+			SplitBlockAndInsertIfThenElse(hit, w.first, &fast, &slow, fast_likely);
+
+			b.SetInsertPoint(fast);
+			Value *dirty = b.CreateLoad(ptr_ty, b.CreateStructGEP(cache_ty, cache, 2));
+			Value *chunk = b.CreateLShr(off, write_chunk_exp);
+			Value *byte = b.CreateGEP(byte_ty, b.CreatePointerCast(dirty, PointerType::getUnqual(byte_ty)),
+			    b.CreateLShr(chunk, 3));
+			Value *shift = b.CreateTrunc(b.CreateAnd(chunk, 7), byte_ty);
+			Value *bit = b.CreateShl(ConstantInt::get(byte_ty, 1), shift);
+			b.CreateStore(b.CreateOr(b.CreateLoad(byte_ty, byte), bit), byte);
+
+			b.SetInsertPoint(slow);
+			b.CreateCall(write_mem_slow, {ptr, size});
+		}
+		return PreservedAnalyses::none();
+	}
+
+	/// The pass must run on functions marked optnone as well, which clang does at -O0
+	static bool isRequired()
+	{
+		return true;
+	}
+};
+
+/// Add the pass at the end of the optimization pipeline, whose callback signature depends on the LLVM version
+#if LLVM_VERSION_MAJOR >= 20
+void optimizer_last_add(ModulePassManager &mpm, OptimizationLevel, ThinOrFullLTOPhase)
+#else
+void optimizer_last_add(ModulePassManager &mpm, OptimizationLevel)
+#endif
+{
+	mpm.addPass(createModuleToFunctionPassAdaptor(WriteMemPass()));
+}
+
+} // namespace
+
+extern "C" LLVM_ATTRIBUTE_WEAK PassPluginLibraryInfo llvmGetPassPluginInfo()
+{
+	return {LLVM_PLUGIN_API_VERSION, "rootsim-write-mem", LLVM_VERSION_STRING, [](PassBuilder &pb) {
+			pb.registerPipelineParsingCallback(
+			    [](StringRef name, FunctionPassManager &fpm, ArrayRef<PassBuilder::PipelineElement>) {
+				    if(name != "rootsim-write-mem")
+					    return false;
+				    fpm.addPass(WriteMemPass());
+				    return true;
+			    });
+			// running after the optimizations, most of the writes to local variables have been removed already
+			pb.registerOptimizerLastEPCallback(optimizer_last_add);
+		}};
+}
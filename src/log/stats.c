@@ -67,6 +67,22 @@ const char *const stats_names[] = {
     [STATS_MSG_SILENT] = "silent messages",
     [STATS_MSG_SILENT_TIME] = "silent messages time",
     [STATS_MSG_ANTI] = "anti messages",
+    [STATS_MSG_BATCH] = "message batches",
+    [STATS_MSG_BATCH_SIZE] = "batched messages",
+    [STATS_LP_STEAL] = "stolen lps",
+    [STATS_LP_STEAL_MSGS] = "stolen lps messages",
+    [STATS_LP_STEAL_IMBALANCE] = "stolen lps balanced load",
+    [STATS_LP_REBALANCE] = "rebalanced lps",
+    [STATS_MSG_PROCESSED_RUN] = "processed message runs",
+    [STATS_MSG_REUSED] = "reused messages",
+    [STATS_MSG_ANTI_REMOVED] = "anti messages removed from queue",
+    [STATS_MSG_REVERSED] = "reversed messages",
+    [STATS_OPTIMISM_WINDOW] = "optimism window",
+    [STATS_MSG_SAFE] = "safe messages",
+    [STATS_MSG_ANTI_COALESCED] = "coalesced anti messages",
+    [STATS_CKPT_ARENA] = "checkpoints arena size",
+    [STATS_LP_QUIET_ROLLBACK] = "quiet lps rollbacks",
+    [STATS_CKPT_SAVED] = "checkpoints saved size",
     [STATS_REAL_TIME_GVT] = "gvt real time"
 };
 
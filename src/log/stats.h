@@ -50,6 +50,7 @@ enum stats_thread_type {
 	/// The time spent in checkpointing activities
 	STATS_CKPT_TIME,
 	/// The size of LPs checkpoints
+	/** This is the full size of the checkpointed state, even if a checkpoint actually copies only part of it */
 	STATS_CKPT_SIZE,
 	/// The count of messages processed in coasting forward, i.e. silently executed messages
 	STATS_MSG_SILENT,
@@ -57,6 +58,38 @@ enum stats_thread_type {
 	STATS_MSG_SILENT_TIME,
 	/// The count of generated anti-messages
 	STATS_MSG_ANTI,
+	/// The count of batches of messages published towards other threads
+	STATS_MSG_BATCH,
+	/// The count of messages published towards other threads in batches
+	STATS_MSG_BATCH_SIZE,
+	/// The count of LPs handed over to idle threads
+	STATS_LP_STEAL,
+	/// The count of pending messages moved along with the LPs handed over to idle threads
+	STATS_LP_STEAL_MSGS,
+	/// The load difference between threads removed by handing over LPs to idle threads
+	STATS_LP_STEAL_IMBALANCE,
+	/// The count of LPs moved between threads by the periodic rebalancing
+	STATS_LP_REBALANCE,
+	/// The count of runs of messages of the same LP processed back to back
+	STATS_MSG_PROCESSED_RUN,
+	/// The count of messages sent by rolled back events which have been sent again by their re-execution
+	STATS_MSG_REUSED,
+	/// The count of anti-messages which annihilated their message while it was still pending in the queue
+	STATS_MSG_ANTI_REMOVED,
+	/// The count of messages undone by the reverse dispatcher of the model
+	STATS_MSG_REVERSED,
+	/// The width of the optimism window of the thread, in average GVT advancements, zero if the window is removed
+	STATS_OPTIMISM_WINDOW,
+	/// The count of safe messages processed without logging them, by the LPs in the conservative mode
+	STATS_MSG_SAFE,
+	/// The count of remote anti-messages folded into a coalesced one, sent to the same node by the same rollback
+	STATS_MSG_ANTI_COALESCED,
+	/// The size in bytes of the free checkpoint buffers cached by the thread for the next checkpoints
+	STATS_CKPT_ARENA,
+	/// The count of rollbacks of quiet LPs, which are back to the optimistic mode for their safe messages too
+	STATS_LP_QUIET_ROLLBACK,
+	/// The size in bytes of the data actually copied by the checkpoints, less than #STATS_CKPT_SIZE if incremental
+	STATS_CKPT_SAVED,
 	/// The real time elapsed since last GVT computation
 	STATS_REAL_TIME_GVT, // used internally, don't use elsewhere
 	/// Used to count the members of this enum
@@ -14,16 +14,10 @@
 #include <core/sync.h>
 #include <gvt/termination.h>
 
-/// The lowest LP id between the ones hosted on this node
-uint64_t lid_node_first;
-/// The lowest LP id between the ones hosted on this thread
-__thread uint64_t lid_thread_first;
-/// One plus the highest LP id between the ones hosted on this thread
-__thread uint64_t lid_thread_end;
 /// A pointer to the currently processed LP context
 __thread struct lp_ctx *current_lp;
 /// A pointer to the LP contexts array
-/** Valid entries are contained between #lid_node_first and #lid_node_first + #n_lps_node - 1, limits included */
+/** Valid entries are the ones of the LPs hosted on this node, between #lid_node_first and #lid_node_end - 1 */
 struct lp_ctx *lps;
 /// The number of LPs hosted on this node
 lp_id_t n_lps_node;
@@ -32,44 +26,16 @@ lp_id_t n_lps_node;
 bool lp_initialized;
 #endif
 
-/**
- * @brief Compute the first index of a partition in a linear space of indexes
- * @param part_id the id of the requested partition
- * @param part_cnt the number of requested partitions
- * @param part_fnc the function which computes the partition id from an index
- * @param start_i the first valid index of the space to partition
- * @param tot_i the size of the index space to partition
- *
- * The description is somewhat confusing but this does a simple thing. Each LP has an integer id and we want each
- * node/processing unit to have more or less the same number of LPs assigned to it; this macro computes the first index
- * of the LP to assign to a node/processing unit.
- */
-#define partition_start(part_id, part_cnt, part_fnc, start_i, tot_i)                                                   \
-	__extension__({                                                                                                \
-		lp_id_t _g = (part_id) * (tot_i) / (part_cnt) + (start_i);                                             \
-		while(_g > (start_i) && part_fnc(_g) >= (part_id))                                                     \
-			--_g;                                                                                          \
-		while(part_fnc(_g) < (part_id))                                                                        \
-			++_g;                                                                                          \
-		_g;                                                                                                    \
-	})
-
 /**
  * @brief Initialize the global data structures for the LPs
  */
 void lp_global_init(void)
 {
-	lid_node_first = partition_start(nid, n_nodes, lid_to_nid, 0, global_config.lps);
-	n_lps_node = partition_start(nid + 1, n_nodes, lid_to_nid, 0, global_config.lps) - lid_node_first;
+	placement_global_init();
+	model_allocator_global_init();
 
-	lps = mm_alloc(sizeof(*lps) * n_lps_node);
+	lps = mm_alloc(sizeof(*lps) * (lid_node_end - lid_node_first));
 	lps -= lid_node_first;
-
-	if(n_lps_node < global_config.n_threads) {
-		logger(LOG_WARN, "The simulation will run with %u threads instead of the requested %u", n_lps_node,
-		    global_config.n_threads);
-		global_config.n_threads = n_lps_node;
-	}
 }
 
 /**
@@ -79,6 +45,8 @@ void lp_global_fini(void)
 {
 	lps += lid_node_first;
 	mm_free(lps);
+	model_allocator_global_fini();
+	placement_global_fini();
 }
 
 /**
@@ -86,10 +54,20 @@ void lp_global_fini(void)
  */
 void lp_init(void)
 {
-	lid_thread_first = partition_start(rid, global_config.n_threads, lid_to_rid, lid_node_first, n_lps_node);
-	lid_thread_end = partition_start(rid + 1, global_config.n_threads, lid_to_rid, lid_node_first, n_lps_node);
+	// LPs may send messages to each other during their initialization
+	for(uint64_t i = lid_node_first; i < lid_node_end; ++i) {
+		if(lid_to_rid(i) != rid)
+			continue;
+
+		lps[i].load = 0;
+		lps[i].work = 0;
+		msg_queue_lp_init(&lps[i]);
+	}
+
+	for(uint64_t i = lid_node_first; i < lid_node_end; ++i) {
+		if(lid_to_rid(i) != rid)
+			continue;
 
-	for(uint64_t i = lid_thread_first; i < lid_thread_end; ++i) {
 		struct lp_ctx *lp = &lps[i];
 
 		model_allocator_lp_init(&lp->mm_state);
@@ -106,14 +84,21 @@ void lp_init(void)
 
 /**
  * @brief Finalize the data structures of the LPs hosted in the calling thread
+ *
+ * The LPs are not necessarily the ones initialized by the calling thread, since they may have been moved between
+ * threads during the simulation.
  */
 void lp_fini(void)
 {
-	for(uint64_t i = lid_thread_first; i < lid_thread_end; ++i) {
+	for(uint64_t i = lid_node_first; i < lid_node_end; ++i) {
+		if(lid_to_rid(i) != rid)
+			continue;
+
 		struct lp_ctx *lp = &lps[i];
 
 		process_lp_fini(lp);
 		model_allocator_lp_fini(&lp->mm_state);
+		msg_queue_lp_fini(lp);
 	}
 
 	current_lp = NULL;
@@ -11,8 +11,11 @@
 #pragma once
 
 #include <arch/platform.h>
+#include <arch/timer.h>
 #include <core/core.h>
+#include <datatypes/msg_queue.h>
 #include <lp/msg.h>
+#include <lp/placement.h>
 #include <lp/process.h>
 #include <mm/auto_ckpt.h>
 #include <mm/model_allocator.h>
@@ -31,28 +34,16 @@ struct lp_ctx {
 	struct process_ctx p;
 	/// The memory allocator state of this LP
 	struct mm_state mm_state;
+	/// The count of pending messages of this LP in the queue of its thread, used to balance the load between threads
+	uint64_t load;
+	/// The time spent processing the messages of this LP, used to periodically rebalance the LPs between threads
+	timer_uint work;
+#ifdef ROOTSIM_LP_QUEUES
+	/// The pending messages of this LP, handled by the message queue
+	struct msg_queue_lp q;
+#endif
 };
 
-/**
- * @brief Compute the id of the node which hosts a given LP
- * @param lp_id the id of the LP
- * @return the id of the node which hosts the LP identified by @p lp_id
- */
-#define lid_to_nid(lp_id) ((nid_t)((lp_id) * n_nodes / global_config.lps))
-
-/**
- * @brief Compute the id of the thread which hosts a given LP
- * @param lp_id the id of the LP
- * @return the id of the thread which hosts the LP identified by @p lp_id
- *
- * Horrible things may happen if @p lp_id is not locally hosted (use #lid_to_nid() to make sure of that!)
- */
-#define lid_to_rid(lp_id) ((rid_t)(((lp_id) - lid_node_first) * global_config.n_threads / n_lps_node))
-
-extern uint64_t lid_node_first;
-extern __thread uint64_t lid_thread_first;
-extern __thread uint64_t lid_thread_end;
-
 extern __thread struct lp_ctx *current_lp;
 extern struct lp_ctx *lps;
 
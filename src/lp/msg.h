@@ -11,6 +11,7 @@
 #pragma once
 
 #include <core/core.h>
+#include <datatypes/array.h>
 
 #include <limits.h>
 #include <stdatomic.h>
@@ -59,6 +60,8 @@
 struct lp_msg {
 	/// The next element in the message list (used in the message queue)
 	struct lp_msg *next;
+	/// The position of the message in the private queue of its thread, kept only by the addressable queues
+	array_count_t q_pos;
 	/// The id of the recipient LP
 	lp_id_t dest;
 	/// The intended destination logical time of this message
@@ -89,6 +92,18 @@ struct lp_msg {
 
 enum msg_flag { MSG_FLAG_ANTI = 1, MSG_FLAG_PROCESSED = 2 };
 
+/// The identity of a remote message, as listed in the payload of a coalesced remote anti-message
+struct msg_remote_id {
+	/// The id of the recipient LP
+	lp_id_t dest;
+	/// The intended destination logical time of the message
+	simtime_t dest_t;
+	/// The message unique id
+	uint32_t raw_flags;
+	/// The message sequence number
+	uint32_t m_seq;
+};
+
 /**
  * @brief Compute a deterministic order for messages with same timestamp
  * @param a the first message to compare
@@ -0,0 +1,160 @@
+/**
+ * @file lp/placement.c
+ *
+ * @brief LP placement
+ *
+ * The node of each LP is kept in a table covering all the LPs of the simulation, so that finding where to send a
+ * message is a single load. The thread of each LP hosted in the node is kept in a second table, which covers the
+ * range of ids between the lowest and the highest hosted ones.
+ *
+ * By default, the LPs are split in contiguous blocks of ids, first among the nodes and then among the threads of each
+ * node. The model can instead supply a placement function or a placement file, to keep the LPs which communicate
+ * the most on the same thread, or at least on the same node.
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#include <lp/placement.h>
+
+#include <log/log.h>
+#include <mm/mm.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+/// The id of the node hosting each LP
+uint16_t *lid_nodes;
+/// The id of the thread hosting each LP
+/** Valid entries are contained between #lid_node_first and #lid_node_end - 1, limits included */
+_Atomic(rid_t) *lp_owners;
+/// The lowest LP id between the ones hosted on this node
+lp_id_t lid_node_first;
+/// One plus the highest LP id between the ones hosted on this node
+lp_id_t lid_node_end;
+
+/**
+ * @brief Compute the id of the node which hosts a given LP, with the default placement
+ * @param lp_id the id of the LP
+ * @return the id of the node which hosts the LP identified by @p lp_id
+ */
+#define lid_to_nid_block(lp_id) ((nid_t)((lp_id) * n_nodes / global_config.lps))
+
+/**
+ * @brief Compute the id of the thread which hosts a given LP, with the default placement
+ * @param lp_id the id of the LP, it must be hosted in the node
+ * @return the id of the thread which hosts the LP identified by @p lp_id
+ */
+#define lid_to_rid_block(lp_id) ((rid_t)(((lp_id) - lid_node_first) * global_config.n_threads / n_lps_node))
+
+/**
+ * @brief Read the worker threads of the LPs from the placement file
+ * @param workers the array where to store the id of the worker thread of each LP
+ */
+static void placement_file_read(unsigned *workers)
+{
+	FILE *f = fopen(global_config.placement_file, "r");
+	if(f == NULL) {
+		logger(LOG_FATAL, "Unable to open the LP placement file %s", global_config.placement_file);
+		abort();
+	}
+
+	for(lp_id_t i = 0; i < global_config.lps; ++i) {
+		if(fscanf(f, "%u", &workers[i]) != 1) {
+			logger(LOG_FATAL, "The LP placement file %s doesn't list the worker thread of LP %" PRIu64,
+			    global_config.placement_file, i);
+			abort();
+		}
+	}
+
+	fclose(f);
+}
+
+/**
+ * @brief Compute the worker threads of the LPs as requested by the model
+ * @return an array with the id of the worker thread of each LP, to be freed with mm_free()
+ *
+ * Worker threads are numbered node by node: the thread t of the node n has id n * n_threads + t.
+ */
+static unsigned *placement_custom_compute(void)
+{
+	unsigned n_workers = n_nodes * global_config.n_threads;
+	unsigned *workers = mm_alloc(global_config.lps * sizeof(*workers));
+
+	if(global_config.placement_file != NULL)
+		placement_file_read(workers);
+	else
+		for(lp_id_t i = 0; i < global_config.lps; ++i)
+			workers[i] = global_config.placement(i, n_workers);
+
+	for(lp_id_t i = 0; i < global_config.lps; ++i) {
+		if(unlikely(workers[i] >= n_workers)) {
+			logger(LOG_FATAL, "LP %" PRIu64 " has been placed on worker thread %u, out of %u", i, workers[i],
+			    n_workers);
+			abort();
+		}
+		lid_nodes[i] = workers[i] / global_config.n_threads;
+	}
+	return workers;
+}
+
+/**
+ * @brief Initialize the placement tables of the LPs
+ *
+ * If the node hosts less LPs than the requested threads, the count of threads is lowered accordingly. A placement
+ * leaving a node without LPs is rejected.
+ */
+void placement_global_init(void)
+{
+	lid_nodes = mm_alloc(global_config.lps * sizeof(*lid_nodes));
+
+	unsigned *workers = NULL;
+	if(global_config.placement != NULL || global_config.placement_file != NULL)
+		workers = placement_custom_compute();
+	else
+		for(lp_id_t i = 0; i < global_config.lps; ++i)
+			lid_nodes[i] = lid_to_nid_block(i);
+
+	lid_node_first = 0;
+	lid_node_end = 0;
+	n_lps_node = 0;
+	for(lp_id_t i = 0; i < global_config.lps; ++i) {
+		if(lid_to_nid(i) != nid)
+			continue;
+		if(!n_lps_node++)
+			lid_node_first = i;
+		lid_node_end = i + 1;
+	}
+
+	// the threads of a node can't do without LPs, which a custom placement may leave it
+	if(unlikely(!n_lps_node)) {
+		logger(LOG_FATAL, "No LP has been placed on node %d", nid);
+		abort();
+	}
+
+	unsigned n_threads = global_config.n_threads;
+	if(n_lps_node < global_config.n_threads) {
+		logger(LOG_WARN, "The simulation will run with %u threads instead of the requested %u", n_lps_node,
+		    global_config.n_threads);
+		global_config.n_threads = n_lps_node;
+	}
+
+	lp_owners = mm_alloc((lid_node_end - lid_node_first) * sizeof(*lp_owners));
+	lp_owners -= lid_node_first;
+	for(lp_id_t i = lid_node_first; i < lid_node_end; ++i) {
+		rid_t r = PLACEMENT_RID_NONE;
+		if(lid_to_nid(i) == nid)
+			r = workers != NULL ? workers[i] % n_threads % global_config.n_threads : lid_to_rid_block(i);
+		atomic_store_explicit(&lp_owners[i], r, memory_order_relaxed);
+	}
+
+	mm_free(workers);
+}
+
+/**
+ * @brief Finalize the placement tables of the LPs
+ */
+void placement_global_fini(void)
+{
+	mm_free(lp_owners + lid_node_first);
+	mm_free(lid_nodes);
+}
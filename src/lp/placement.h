@@ -0,0 +1,54 @@
+/**
+ * @file lp/placement.h
+ *
+ * @brief LP placement
+ *
+ * The mapping of the LPs on the nodes and on the threads of the simulation
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#pragma once
+
+#include <core/core.h>
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/// The thread id kept in the owners table for the LPs not hosted in the node
+#define PLACEMENT_RID_NONE ((rid_t)-1)
+
+/**
+ * @brief Compute the id of the node which hosts a given LP
+ * @param lp_id the id of the LP
+ * @return the id of the node which hosts the LP identified by @p lp_id
+ */
+#define lid_to_nid(lp_id) ((nid_t)lid_nodes[(lp_id)])
+
+/**
+ * @brief Compute the id of the thread which hosts a given LP
+ * @param lp_id the id of the LP
+ * @return the id of the thread which hosts the LP identified by @p lp_id
+ *
+ * Horrible things may happen if @p lp_id is not locally hosted (use #lid_to_nid() to make sure of that!)
+ * LPs may be moved between threads during the simulation, see lp_owner_set(). The acquire ordering guarantees that a
+ * thread which sends a message to the new owner of an LP makes visible to it the changes done by the former owner.
+ */
+#define lid_to_rid(lp_id) ((rid_t)atomic_load_explicit(&lp_owners[(lp_id)], memory_order_acquire))
+
+/**
+ * @brief Change the thread which hosts a given LP
+ * @param lp_id the id of the LP, it must be hosted by the calling thread
+ * @param dest_rid the id of the new hosting thread
+ *
+ * The calling thread must not touch the LP context after this call.
+ */
+#define lp_owner_set(lp_id, dest_rid) atomic_store_explicit(&lp_owners[(lp_id)], (dest_rid), memory_order_release)
+
+extern uint16_t *lid_nodes;
+extern _Atomic(rid_t) *lp_owners;
+extern lp_id_t lid_node_first;
+extern lp_id_t lid_node_end;
+
+extern void placement_global_init(void);
+extern void placement_global_fini(void);
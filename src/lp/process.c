@@ -15,13 +15,25 @@
 #include <distributed/mpi.h>
 #include <gvt/fossil.h>
 #include <gvt/gvt.h>
+#include <gvt/throttle.h>
 #include <log/stats.h>
 #include <lp/common.h>
 #include <lp/lp.h>
 #include <mm/auto_ckpt.h>
 #include <mm/msg_allocator.h>
+#include <parallel/balance.h>
 #include <serial/serial.h>
 
+#include <assert.h>
+
+/// The maximum count of messages of the same LP processed back to back by process_msg()
+#define PROCESS_RUN_MAX 16U
+/// The count of consecutive GVTs without rollbacks after which an LP is quiet, with the hybrid synchronization
+#define PROCESS_QUIET_GVTS 4U
+/// Tell if an LP has not rolled back for at least #PROCESS_QUIET_GVTS GVTs
+/** The fossil collection epoch counts the GVTs, so this is the classification the LP would get at the last GVT */
+#define process_is_quiet(lp) (fossil_epoch_current - (lp)->p.rollback_epoch >= PROCESS_QUIET_GVTS)
+
 /// The flag used in ScheduleNewEvent() to keep track of silent execution
 static __thread bool silent_processing = false;
 #ifndef NDEBUG
@@ -35,6 +47,139 @@ static __thread struct lp_msg *current_msg;
 #define unmark_msg_remote(msg_p) ((struct lp_msg *)(((uintptr_t)(msg_p)) - 2U))
 #define unmark_msg_sent(msg_p) ((struct lp_msg *)(((uintptr_t)(msg_p)) - 1U))
 
+static void lazy_cancels_flush(struct process_ctx *proc_p, const struct lp_msg *gen);
+
+/**
+ * @brief Send the anti-message of a message sent by a rolled back event
+ * @param msg the sent message, marked as in the processed messages array
+ *
+ * A local message not yet processed is simply flagged, so that its receiver discards it once extracted. If the
+ * receiver is hosted by the current thread, the message is instead removed from the queue, when possible.
+ */
+static inline void anti_msg_send(struct lp_msg *msg)
+{
+	if(is_msg_remote(msg)) {
+		msg = unmark_msg_remote(msg);
+		nid_t dest_nid = lid_to_nid(msg->dest);
+		mpi_remote_anti_msg_send(&msg, 1, dest_nid);
+		msg_allocator_free_at_gvt(msg);
+	} else {
+		msg = unmark_msg_sent(msg);
+		uint32_t f = atomic_fetch_add_explicit(&msg->flags, MSG_FLAG_ANTI, memory_order_relaxed);
+		if(f & MSG_FLAG_PROCESSED) {
+			msg_queue_insert(msg);
+		} else if(lid_to_rid(msg->dest) == rid && msg_queue_remove(msg)) {
+			// the receiver is hosted here and hasn't extracted the message yet: annihilate it right away
+			struct process_ctx *proc_p = &lps[msg->dest].p;
+			if(unlikely(!array_is_empty(proc_p->cancels)))
+				lazy_cancels_flush(proc_p, msg);
+			msg_allocator_free(msg);
+			stats_take(STATS_MSG_ANTI_REMOVED, 1);
+		}
+	}
+	stats_take(STATS_MSG_ANTI, 1);
+}
+
+/**
+ * @brief Compares two messages so that qsort() lays them out by destination node, destination LP and timestamp
+ * @param a a pointer to the first message pointer
+ * @param b a pointer to the second message pointer
+ * @return a value which is negative if @p a should be placed before @p b, positive if after, zero otherwise
+ */
+static int anti_msg_cmp(const void *a, const void *b)
+{
+	const struct lp_msg *ma = *(struct lp_msg *const *)a, *mb = *(struct lp_msg *const *)b;
+	nid_t na = lid_to_nid(ma->dest), nb = lid_to_nid(mb->dest);
+	if(na != nb)
+		return (na > nb) - (na < nb);
+	if(ma->dest != mb->dest)
+		return (ma->dest > mb->dest) - (ma->dest < mb->dest);
+	return (ma->dest_t > mb->dest_t) - (ma->dest_t < mb->dest_t);
+}
+
+/**
+ * @brief Send the anti-messages of the remote messages sent by some rolled back events
+ * @param msgs the remote messages, marked as in the processed messages array, which get reordered and unmarked
+ * @param n the count of messages in @p msgs
+ *
+ * The anti-messages addressed to the same node are coalesced into a single one. The cancelled messages are grouped by
+ * destination LP, each group led by its earliest message, so that the receiver handles each group with one rollback.
+ */
+static void anti_msgs_remote_send(struct lp_msg **msgs, array_count_t n)
+{
+	for(array_count_t i = 0; i < n; ++i)
+		msgs[i] = unmark_msg_remote(msgs[i]);
+	qsort(msgs, n, sizeof(*msgs), anti_msg_cmp);
+
+	for(array_count_t i = 0; i < n;) {
+		nid_t dest_nid = lid_to_nid(msgs[i]->dest);
+		array_count_t j = i + 1;
+		while(j < n && lid_to_nid(msgs[j]->dest) == dest_nid)
+			++j;
+
+		mpi_remote_anti_msg_send(msgs + i, j - i, dest_nid);
+		stats_take(STATS_MSG_ANTI, 1);
+		stats_take(STATS_MSG_ANTI_COALESCED, j - i - 1);
+		for(; i < j; ++i)
+			msg_allocator_free_at_gvt(msgs[i]);
+	}
+}
+
+/**
+ * @brief Look for a message sent by a rolled back event which is identical to a newly sent one
+ * @param proc_p the message processing data of the current LP
+ * @param receiver the id of the LP which should receive the new message
+ * @param timestamp the timestamp of the new message
+ * @param event_type the type of the new message
+ * @param payload the payload of the new message
+ * @param payload_size the size of the payload of the new message
+ * @return true if an identical message has been found and it has been kept in place of the new one, false otherwise
+ *
+ * Identical messages induce the same state change in the receiving LP, so there's no need to tell apart the rolled
+ * back event which originally sent the message.
+ */
+static bool lazy_cancels_match(struct process_ctx *proc_p, lp_id_t receiver, simtime_t timestamp, unsigned event_type,
+    const void *payload, unsigned payload_size)
+{
+	for(array_count_t i = 0; i < array_count(proc_p->cancels); ++i) {
+		struct lp_msg *msg = array_get_at(proc_p->cancels, i).msg;
+		const struct lp_msg *m = unmark_msg(msg);
+		if(m->dest != receiver || m->dest_t != timestamp || m->m_type != event_type ||
+		    m->pl_size != payload_size || memcmp(m->pl, payload, payload_size))
+			continue;
+
+		array_lazy_remove_at(proc_p->cancels, i);
+		if(likely(!proc_p->conservative))
+			array_push(proc_p->p_msgs, msg);
+		else if(is_msg_remote(msg))
+			msg_allocator_free_at_gvt(unmark_msg_remote(msg));
+		stats_take(STATS_MSG_REUSED, 1);
+		return true;
+	}
+	return false;
+}
+
+/**
+ * @brief Annihilate the messages of a rolled back event which haven't been sent again
+ * @param proc_p the message processing data of the current LP
+ * @param gen the rolled back event, either just processed again or annihilated
+ */
+static void lazy_cancels_flush(struct process_ctx *proc_p, const struct lp_msg *gen)
+{
+	array_count_t i = array_count(proc_p->cancels);
+	while(i--) {
+		struct process_cancel c = array_get_at(proc_p->cancels, i);
+		if(c.gen != gen)
+			continue;
+
+		array_lazy_remove_at(proc_p->cancels, i);
+		anti_msg_send(c.msg);
+		// the anti-message may have annihilated in place another rolled back event, flushing its messages too
+		if(i > array_count(proc_p->cancels))
+			i = array_count(proc_p->cancels);
+	}
+}
+
 void ScheduleNewEvent(lp_id_t receiver, simtime_t timestamp, unsigned event_type, const void *payload,
     unsigned payload_size)
 {
@@ -46,6 +191,17 @@ void ScheduleNewEvent(lp_id_t receiver, simtime_t timestamp, unsigned event_type
 	if(unlikely(silent_processing))
 		return;
 
+	if(unlikely(!array_is_empty(current_lp->p.cancels)) &&
+	    lazy_cancels_match(&current_lp->p, receiver, timestamp, event_type, payload, payload_size))
+		return;
+
+	// the synchronization relies on the declared lookahead, so a model breaking it is stopped in release builds too
+	if(unlikely(global_config.lookahead > 0.0 && current_msg->m_type != LP_INIT &&
+	    timestamp < current_msg->dest_t + global_config.lookahead)) {
+		logger(LOG_FATAL, "Scheduling a message within the declared lookahead!");
+		abort();
+	}
+
 	struct lp_msg *msg = msg_allocator_pack(receiver, timestamp, event_type, payload, payload_size);
 
 #ifndef NDEBUG
@@ -57,15 +213,70 @@ void ScheduleNewEvent(lp_id_t receiver, simtime_t timestamp, unsigned event_type
 	msg->send_t = current_msg->dest_t;
 #endif
 
+	// the messages sent by safe messages are never cancelled, so they aren't logged
 	nid_t dest_nid = lid_to_nid(receiver);
 	if(dest_nid != nid) {
 		mpi_remote_msg_send(msg, dest_nid);
-		array_push(current_lp->p.p_msgs, mark_msg_remote(msg));
+		if(likely(!current_lp->p.conservative))
+			array_push(current_lp->p.p_msgs, mark_msg_remote(msg));
+		else
+			msg_allocator_free_at_gvt(msg);
 	} else {
 		atomic_store_explicit(&msg->flags, 0U, memory_order_relaxed);
 		msg_queue_insert(msg);
-		array_push(current_lp->p.p_msgs, mark_msg_sent(msg));
+		if(likely(!current_lp->p.conservative))
+			array_push(current_lp->p.p_msgs, mark_msg_sent(msg));
+	}
+}
+
+/**
+ * @brief Log some information destroyed by the event being processed
+ * @param bits the information to log, only its @p width least significant bits are kept
+ * @param width the count of bits to log, between 1 and 64
+ *
+ * The information is only needed by the reverse dispatcher, so nothing is logged if the model doesn't supply one or if
+ * the event can't be rolled back.
+ */
+void rs_bitlog_push(uint64_t bits, unsigned width)
+{
+	if(unlikely(global_config.serial || global_config.reverse_dispatcher == NULL || current_lp->p.conservative))
+		return;
+
+	if(unlikely(!width || width > 64)) {
+		logger(LOG_FATAL, "rs_bitlog_push() is being called with an invalid width of %u bits!", width);
+		abort();
+	}
+	bitlog_push(&current_lp->p.r_log, bits, width);
+}
+
+/**
+ * @brief Retrieve some information logged by the event being undone
+ * @param width the count of bits to retrieve, between 1 and 64
+ * @return the bits logged by the last matching rs_bitlog_push() call
+ */
+uint64_t rs_bitlog_pop(unsigned width)
+{
+	struct process_ctx *proc_p = &current_lp->p;
+	if(unlikely(!silent_processing || array_is_empty(proc_p->r_marks) || !width || width > 64 ||
+	    bitlog_end(&proc_p->r_log) - array_peek(proc_p->r_marks) < width)) {
+		logger(LOG_FATAL, "rs_bitlog_pop() is being called past the bits logged by the undone event!");
+		abort();
 	}
+	return bitlog_pop(&proc_p->r_log, width);
+}
+
+/**
+ * @brief Append a processed message to the processed messages array, indexing it
+ * @param proc_p the message processing data of the current LP
+ * @param msg the processed message, whose flags have just been updated by its processing
+ */
+static inline void process_msg_push(struct process_ctx *proc_p, struct lp_msg *msg)
+{
+	// remote messages carry their unique id in the flags, local ones only the processing flags
+	bool remote = msg->raw_flags > (MSG_FLAG_ANTI | MSG_FLAG_PROCESSED);
+	uint64_t key = remote ? process_key_remote(msg) : process_key_local(msg);
+	hmap_insert(&proc_p->p_index, key, proc_p->p_base + array_count(proc_p->p_msgs));
+	array_push(proc_p->p_msgs, msg);
 }
 
 /**
@@ -77,7 +288,8 @@ void ScheduleNewEvent(lp_id_t receiver, simtime_t timestamp, unsigned event_type
 static inline void checkpoint_take(struct lp_ctx *lp)
 {
 	timer_uint t = timer_hr_new();
-	model_allocator_checkpoint_take(&lp->mm_state, array_count(lp->p.p_msgs));
+	stats_take(STATS_CKPT_SAVED, model_allocator_checkpoint_take(&lp->mm_state, array_count(lp->p.p_msgs)));
+	// the autonomic checkpointing scales the cost per byte by the full state size, whatever was actually copied
 	stats_take(STATS_CKPT_SIZE, lp->mm_state.full_ckpt_size);
 	stats_take(STATS_CKPT, 1);
 	stats_take(STATS_CKPT_TIME, timer_hr_value(t));
@@ -89,7 +301,14 @@ static inline void checkpoint_take(struct lp_ctx *lp)
 void process_lp_init(struct lp_ctx *lp)
 {
 	array_init(lp->p.p_msgs);
-	lp->p.early_antis = NULL;
+	array_init(lp->p.cancels);
+	hmap_init(&lp->p.p_index);
+	lp->p.p_base = 0;
+	hmap_init(&lp->p.early_antis);
+	bitlog_init(&lp->p.r_log);
+	array_init(lp->p.r_marks);
+	lp->p.rollback_epoch = fossil_epoch_current - PROCESS_QUIET_GVTS;
+	lp->p.conservative = global_config.lookahead > 0.0;
 
 	struct lp_msg *msg = msg_allocator_pack(lp - lps, 0, LP_INIT, NULL, 0U);
 	msg->raw_flags = MSG_FLAG_PROCESSED;
@@ -97,9 +316,17 @@ void process_lp_init(struct lp_ctx *lp)
 	current_msg = msg;
 #endif
 	current_lp = lp;
+	if(global_config.reverse_dispatcher != NULL && !lp->p.conservative)
+		array_push(lp->p.r_marks, bitlog_end(&lp->p.r_log));
 	common_msg_process(lp, msg);
+	if(lp->p.conservative) {
+		// with a lookahead the LPs start conservatively, so neither the message nor a checkpoint are kept
+		msg_allocator_free(msg);
+		lp->p.bound = -1.0;
+		return;
+	}
 	lp->p.bound = 0.0;
-	array_push(lp->p.p_msgs, msg);
+	process_msg_push(&lp->p, msg);
 	model_allocator_checkpoint_next_force_full(&lp->mm_state);
 	checkpoint_take(lp);
 }
@@ -125,6 +352,22 @@ void process_lp_fini(struct lp_ctx *lp)
 			msg_allocator_free(msg);
 	}
 	array_fini(lp->p.p_msgs);
+	hmap_fini(&lp->p.p_index);
+
+	for(array_count_t i = 0; i < hmap_capacity(&lp->p.early_antis); ++i)
+		if(hmap_slot_at(&lp->p.early_antis, i).key)
+			msg_allocator_free((struct lp_msg *)(uintptr_t)hmap_slot_at(&lp->p.early_antis, i).val);
+	hmap_fini(&lp->p.early_antis);
+
+	for(array_count_t i = 0; i < array_count(lp->p.cancels); ++i) {
+		struct lp_msg *msg = array_get_at(lp->p.cancels, i).msg;
+		if(is_msg_remote(msg))
+			msg_allocator_free(unmark_msg_remote(msg));
+	}
+	array_fini(lp->p.cancels);
+
+	bitlog_fini(&lp->p.r_log);
+	array_fini(lp->p.r_marks);
 }
 
 /**
@@ -157,40 +400,78 @@ static inline void silent_execution(const struct lp_ctx *lp, array_count_t last_
 	stats_take(STATS_MSG_SILENT_TIME, timer_hr_value(t));
 }
 
+/**
+ * @brief Perform reverse execution of events
+ * @param lp the LP that has to undo its events
+ * @param past_i the index in the processed messages array of the LP of the first message to undo
+ *
+ * This function replaces the checkpoint restore and the coasting forward when the model supplies a reverse dispatcher.
+ */
+static inline void reverse_execution(struct lp_ctx *lp, array_count_t past_i)
+{
+	silent_processing = true;
+
+	array_count_t i = array_count(lp->p.p_msgs);
+	while(i-- > past_i) {
+		const struct lp_msg *msg = array_get_at(lp->p.p_msgs, i);
+		if(is_msg_sent(msg))
+			continue;
+
+		global_config.reverse_dispatcher(msg->dest, msg->dest_t, msg->m_type, msg->pl, msg->pl_size,
+		    lp->state_pointer);
+		if(unlikely(array_pop(lp->p.r_marks) != bitlog_end(&lp->p.r_log))) {
+			logger(LOG_FATAL, "The reverse dispatcher didn't pop all the bits logged by the undone event!");
+			abort();
+		}
+		stats_take(STATS_MSG_REVERSED, 1);
+	}
+
+	silent_processing = false;
+}
+
 /**
  * @brief Send anti-messages
  * @param proc_p the message processing data for the LP that has to send anti-messages
  * @param past_i the index in @a proc_p of the last validly processed message
+ *
+ * With the lazy cancellation, the messages sent by a rolled back event are annihilated only once the event has been
+ * processed again, and only if they haven't been sent again. This can't be done for the events which are being
+ * annihilated themselves.
  */
 static inline void send_anti_messages(struct process_ctx *proc_p, array_count_t past_i)
 {
-	array_count_t p_cnt = array_count(proc_p->p_msgs);
+	array_count_t p_cnt = array_count(proc_p->p_msgs), r_cnt = past_i;
 	for(array_count_t i = past_i; i < p_cnt; ++i) {
+		array_count_t sent_i = i;
 		struct lp_msg *msg = array_get_at(proc_p->p_msgs, i);
-
-		while(is_msg_sent(msg)) {
-			if(is_msg_remote(msg)) {
-				msg = unmark_msg_remote(msg);
-				nid_t dest_nid = lid_to_nid(msg->dest);
-				mpi_remote_anti_msg_send(msg, dest_nid);
-				msg_allocator_free_at_gvt(msg);
-			} else {
-				msg = unmark_msg_sent(msg);
-				uint32_t f =
-				    atomic_fetch_add_explicit(&msg->flags, MSG_FLAG_ANTI, memory_order_relaxed);
-				if(f & MSG_FLAG_PROCESSED)
-					msg_queue_insert(msg);
-			}
-
-			stats_take(STATS_MSG_ANTI, 1);
+		while(is_msg_sent(msg))
 			msg = array_get_at(proc_p->p_msgs, ++i);
-		}
 
+		process_index_remove(proc_p, msg);
 		uint32_t f = atomic_fetch_add_explicit(&msg->flags, -MSG_FLAG_PROCESSED, memory_order_relaxed);
-		if(!(f & MSG_FLAG_ANTI))
+		if(!(f & MSG_FLAG_ANTI)) {
 			msg_queue_insert_self(msg);
+			if(global_config.lazy_cancellation) {
+				for(; sent_i < i; ++sent_i) {
+					struct process_cancel c = {.msg = array_get_at(proc_p->p_msgs, sent_i)};
+					c.gen = msg;
+					array_push(proc_p->cancels, c);
+				}
+			}
+		}
+
+		for(; sent_i < i; ++sent_i) {
+			struct lp_msg *s_msg = array_get_at(proc_p->p_msgs, sent_i);
+			// the remote ones are gathered in the slots already scanned, to be coalesced at the end
+			if(is_msg_remote(s_msg))
+				array_get_at(proc_p->p_msgs, r_cnt++) = s_msg;
+			else
+				anti_msg_send(s_msg);
+		}
 		stats_take(STATS_MSG_ROLLBACK, 1);
 	}
+	if(r_cnt != past_i)
+		anti_msgs_remote_send(&array_get_at(proc_p->p_msgs, past_i), r_cnt - past_i);
 	array_count(proc_p->p_msgs) = past_i;
 }
 
@@ -202,29 +483,47 @@ static inline void send_anti_messages(struct process_ctx *proc_p, array_count_t
 static void do_rollback(struct lp_ctx *lp, array_count_t past_i)
 {
 	timer_uint t = timer_hr_new();
-	send_anti_messages(&lp->p, past_i);
-	array_count_t last_i = model_allocator_checkpoint_restore(&lp->mm_state, past_i);
+	array_count_t last_i = past_i;
+	if(likely(global_config.reverse_dispatcher == NULL)) {
+		send_anti_messages(&lp->p, past_i);
+		last_i = model_allocator_checkpoint_restore(&lp->mm_state, past_i);
+	} else {
+		reverse_execution(lp, past_i);
+		send_anti_messages(&lp->p, past_i);
+	}
 	stats_take(STATS_RECOVERY_TIME, timer_hr_value(t));
 	stats_take(STATS_ROLLBACK, 1);
+	if(global_config.hybrid_synchronization && process_is_quiet(lp))
+		stats_take(STATS_LP_QUIET_ROLLBACK, 1);
+	lp->p.rollback_epoch = fossil_epoch_current;
 	silent_execution(lp, last_i, past_i);
 }
 
 /**
  * @brief Find the last valid processed message with respect to a straggler message
  * @param proc_p the message processing data for the LP
- * @param s_msg the straggler message
+ * @param s_msg the straggler message, it must precede the last processed message
  * @return the index in @a proc_p of the last validly processed message
+ *
+ * The processed messages are laid out in processing order, so this is a binary search for the first position whose
+ * message follows the straggler. A position holding a sent message is resolved to the processed message that sent
+ * it, which comes right after its sent messages: this way the markers cost a short forward scan per probe.
  */
 static inline array_count_t match_straggler_msg(const struct process_ctx *proc_p, const struct lp_msg *s_msg)
 {
-	array_count_t i = array_count(proc_p->p_msgs) - 1;
-	const struct lp_msg *msg;
-	do {
-		if(!i)
-			return 0;
-		msg = array_get_at(proc_p->p_msgs, --i);
-	} while(is_msg_sent(msg) || msg_is_before(s_msg, msg));
-	return i + 1;
+	array_count_t lo = 0, hi = array_count(proc_p->p_msgs) - 1;
+	while(lo < hi) {
+		array_count_t mid = lo + (hi - lo) / 2, i = mid;
+		const struct lp_msg *msg;
+		while(is_msg_sent(msg = array_get_at(proc_p->p_msgs, i)))
+			++i;
+
+		if(msg_is_before(s_msg, msg))
+			hi = mid;
+		else
+			lo = i + 1;
+	}
+	return lo;
 }
 
 /**
@@ -235,13 +534,15 @@ static inline array_count_t match_straggler_msg(const struct process_ctx *proc_p
  */
 static inline array_count_t match_anti_msg(const struct process_ctx *proc_p, const struct lp_msg *a_msg)
 {
-	array_count_t i = array_count(proc_p->p_msgs) - 1;
-	const struct lp_msg *msg = array_get_at(proc_p->p_msgs, i);
-	while(a_msg != msg)
-		msg = array_get_at(proc_p->p_msgs, --i);
+	uint64_t pos = 0;
+	// a local anti-message is only delivered after its original counterpart has been processed
+	bool found = hmap_lookup(&proc_p->p_index, process_key_local(a_msg), &pos);
+	assert(found);
+	(void)found;
+	array_count_t i = pos - proc_p->p_base;
 
 	while(i) {
-		msg = array_get_at(proc_p->p_msgs, --i);
+		const struct lp_msg *msg = array_get_at(proc_p->p_msgs, --i);
 		if(is_msg_past(msg))
 			return i + 1;
 	}
@@ -252,38 +553,69 @@ static inline array_count_t match_anti_msg(const struct process_ctx *proc_p, con
  * @brief Handle the reception of a remote anti-message
  * @param proc_p the message processing data for the LP that has to handle the anti-message
  * @param a_msg the remote anti-message
+ *
+ * A coalesced anti-message also lists in its payload the identities of other messages to annihilate: the processed
+ * ones are all rolled back at once. The identities destined to other LPs, which may follow, are handled by the
+ * anti-messages split off for those LPs on reception.
  */
 static inline void handle_remote_anti_msg(struct lp_ctx *lp, struct lp_msg *a_msg)
 {
 	// Simplifies flags-based matching, also useful in the early remote anti-messages matching
 	a_msg->raw_flags -= MSG_FLAG_ANTI;
 
-	uint32_t m_id = a_msg->raw_flags, m_seq = a_msg->m_seq;
-	array_count_t i = array_count(lp->p.p_msgs);
-	struct lp_msg *msg;
-	do {
-		if(unlikely(!i)) {
-			// Sadly this is an early remote anti-message
-			a_msg->next = lp->p.early_antis;
-			lp->p.early_antis = a_msg;
-			return;
-		}
-		msg = array_get_at(lp->p.p_msgs, --i);
-	} while(is_msg_sent(msg) || msg->raw_flags != m_id || msg->m_seq != m_seq);
+	array_count_t n = a_msg->pl_size / sizeof(struct msg_remote_id), k = 0;
+	struct lp_msg *a_orig, **origs = likely(!n) ? &a_orig : mm_alloc((n + 1) * sizeof(*origs));
+	uint64_t pos, past_pos = UINT64_MAX;
 
-	while(i) {
-		const struct lp_msg *v_msg = array_get_at(lp->p.p_msgs, --i);
-		if(is_msg_past(v_msg)) {
-			i++;
+	bool early = !hmap_lookup(&lp->p.p_index, process_key_remote(a_msg), &pos);
+	if(unlikely(early)) {
+		// Sadly this is an early remote anti-message
+		hmap_insert(&lp->p.early_antis, process_key_remote(a_msg), (uintptr_t)a_msg);
+	} else {
+		origs[k++] = array_get_at(lp->p.p_msgs, pos - lp->p.p_base);
+		past_pos = pos;
+	}
+
+	for(array_count_t j = 0; j < n; ++j) {
+		struct msg_remote_id id;
+		memcpy(&id, a_msg->pl + j * sizeof(id), sizeof(id));
+		if(id.dest != a_msg->dest)
 			break;
+
+		if(hmap_lookup(&lp->p.p_index, process_key_remote(&id), &pos)) {
+			origs[k++] = array_get_at(lp->p.p_msgs, pos - lp->p.p_base);
+			past_pos = min(past_pos, pos);
+			continue;
 		}
+		// the early anti-message only has to be reclaimed by the fossil collection if left unmatched
+		struct lp_msg *e_msg = msg_allocator_alloc(0);
+		e_msg->dest_t = id.dest_t;
+		hmap_insert(&lp->p.early_antis, process_key_remote(&id), (uintptr_t)e_msg);
 	}
 
-	msg->raw_flags |= MSG_FLAG_ANTI;
-	do_rollback(lp, i);
-	termination_on_lp_rollback(lp, msg->dest_t);
-	msg_allocator_free(msg);
-	msg_allocator_free(a_msg);
+	if(likely(k)) {
+		array_count_t i = past_pos - lp->p.p_base;
+		simtime_t t = array_get_at(lp->p.p_msgs, i)->dest_t;
+		while(i) {
+			const struct lp_msg *v_msg = array_get_at(lp->p.p_msgs, --i);
+			if(is_msg_past(v_msg)) {
+				i++;
+				break;
+			}
+		}
+
+		for(array_count_t j = 0; j < k; ++j)
+			origs[j]->raw_flags |= MSG_FLAG_ANTI;
+		do_rollback(lp, i);
+		termination_on_lp_rollback(lp, t);
+		for(array_count_t j = 0; j < k; ++j)
+			msg_allocator_free(origs[j]);
+	}
+
+	if(unlikely(n))
+		mm_free(origs);
+	if(likely(!early))
+		msg_allocator_free(a_msg);
 }
 
 /**
@@ -294,20 +626,16 @@ static inline void handle_remote_anti_msg(struct lp_ctx *lp, struct lp_msg *a_ms
  */
 static inline bool check_early_anti_messages(struct process_ctx *proc_p, struct lp_msg *msg)
 {
-	uint32_t m_id = msg->raw_flags, m_seq = msg->m_seq;
-	struct lp_msg **prev_p = &proc_p->early_antis;
-	struct lp_msg *a_msg = *prev_p;
-	do {
-		if(a_msg->raw_flags == m_id && a_msg->m_seq == m_seq) {
-			*prev_p = a_msg->next;
-			msg_allocator_free(msg);
-			msg_allocator_free(a_msg);
-			return true;
-		}
-		prev_p = &a_msg->next;
-		a_msg = *prev_p;
-	} while(a_msg != NULL);
-	return false;
+	uint64_t key = process_key_remote(msg), a_msg;
+	if(!hmap_lookup(&proc_p->early_antis, key, &a_msg))
+		return false;
+
+	hmap_remove(&proc_p->early_antis, key);
+	if(unlikely(!array_is_empty(proc_p->cancels)))
+		lazy_cancels_flush(proc_p, msg);
+	msg_allocator_free(msg);
+	msg_allocator_free((struct lp_msg *)(uintptr_t)a_msg);
+	return true;
 }
 
 /**
@@ -328,6 +656,9 @@ static void handle_anti_msg(struct lp_ctx *lp, struct lp_msg *msg, uint32_t last
 		termination_on_lp_rollback(lp, msg->dest_t);
 		auto_ckpt_register_bad(&lp->auto_ckpt);
 	}
+
+	if(unlikely(!array_is_empty(lp->p.cancels)))
+		lazy_cancels_flush(&lp->p, msg);
 	msg_allocator_free(msg);
 }
 
@@ -344,56 +675,188 @@ static void handle_straggler_msg(struct lp_ctx *lp, struct lp_msg *msg)
 	auto_ckpt_register_bad(&lp->auto_ckpt);
 }
 
+/**
+ * @brief Carry out the bookkeeping due after an LP has processed a run of messages
+ * @param lp the processing context of the current LP
+ * @param t the timer started before processing the run
+ * @param last_t the timestamp of the last processed message of the run
+ */
+static void process_run_end(struct lp_ctx *lp, timer_uint t, simtime_t last_t)
+{
+	balance_on_msg_process(lp, timer_hr_value(t));
+	stats_take(STATS_MSG_PROCESSED_RUN, 1);
+
+	if(global_config.reverse_dispatcher == NULL && !lp->p.conservative && auto_ckpt_is_needed(&lp->auto_ckpt))
+		checkpoint_take(lp);
+
+	termination_on_msg_process(lp, last_t);
+}
+
+/**
+ * @brief Move an LP to the conservative mode
+ * @param lp the processing context of the LP, whose processed messages can't be rolled back anymore
+ *
+ * This is a fossil collection of all the processed messages, only the last checkpoint is kept.
+ */
+static void process_mode_conservative(struct lp_ctx *lp)
+{
+	struct process_ctx *proc_p = &lp->p;
+	array_count_t k = array_count(proc_p->p_msgs);
+	if(global_config.reverse_dispatcher == NULL)
+		model_allocator_fossil_lp_collect(&lp->mm_state, k);
+
+	proc_p->p_base += k;
+	while(k--) {
+		struct lp_msg *msg = array_get_at(proc_p->p_msgs, k);
+		if(is_msg_past(msg))
+			process_index_remove(proc_p, msg);
+		if(!is_msg_local_sent(msg))
+			msg_allocator_free(unmark_msg(msg));
+	}
+	array_count(proc_p->p_msgs) = 0;
+
+	if(global_config.reverse_dispatcher != NULL) {
+		array_count(proc_p->r_marks) = 0;
+		bitlog_discard(&proc_p->r_log, bitlog_end(&proc_p->r_log));
+	}
+
+	proc_p->bound = -1.0;
+	proc_p->conservative = true;
+}
+
+/**
+ * @brief Move an LP back to the optimistic mode
+ * @param lp the processing context of the LP, which is about to process a message past the safe bound
+ *
+ * The state of the LP is checkpointed, so that the following messages can be rolled back up to this point.
+ */
+static void process_mode_optimistic(struct lp_ctx *lp)
+{
+	lp->p.conservative = false;
+	if(global_config.reverse_dispatcher != NULL)
+		return;
+
+	// the checkpoint left by process_mode_conservative() is stale, this one replaces it
+	model_allocator_checkpoint_next_force_full(&lp->mm_state);
+	checkpoint_take(lp);
+	model_allocator_fossil_lp_collect(&lp->mm_state, 0);
+}
+
+/**
+ * @brief Process a message in the conservative mode
+ * @param lp the processing context of the current LP
+ * @param msg the message to process, which is known to be safe
+ *
+ * A safe message can't be rolled back, so it isn't logged and it is freed right after its processing.
+ */
+static void process_msg_conservative(struct lp_ctx *lp, struct lp_msg *msg)
+{
+	timer_uint t = timer_hr_new();
+	gvt_on_msg_extraction(msg->dest_t);
+
+#ifndef NDEBUG
+	current_msg = msg;
+#endif
+
+	common_msg_process(lp, msg);
+	stats_take(STATS_MSG_SAFE, 1);
+	simtime_t last_t = msg->dest_t;
+	msg_allocator_free(msg);
+
+	balance_on_msg_process(lp, timer_hr_value(t));
+	termination_on_msg_process(lp, last_t);
+}
+
 /**
  * @brief Extract and process a message, if available
  *
  * This function encloses most of the actual parallel/distributed simulation logic.
+ *
+ * The following messages in the queue destined to the same LP are processed right away, up to #PROCESS_RUN_MAX of
+ * them: the fossil collection check is done once for the whole run, while the checkpoint and termination checks are
+ * done once at its end. The run stops early at the first anti-message or annihilated message.
  */
 void process_msg(void)
 {
 	timer_uint t = timer_hr_new();
-	struct lp_msg *msg = msg_queue_extract();
+	struct lp_msg *msg;
+	if(likely(throttle_bound == SIMTIME_MAX))
+		msg = msg_queue_extract();
+	else
+		msg = msg_queue_extract_before(throttle_bound);
 	stats_take(STATS_MSG_EXTRACTION, timer_hr_value(t));
 	if(unlikely(!msg)) {
 		current_lp = NULL;
 		return;
 	}
 
-	gvt_on_msg_extraction(msg->dest_t);
+	if(unlikely(balance_lp_pending()))
+		balance_poll();
 
 	struct lp_ctx *lp = &lps[msg->dest];
 	current_lp = lp;
 
+	if(unlikely(global_config.lookahead > 0.0 && !global_config.hybrid_synchronization)) {
+		process_msg_conservative(lp, msg);
+		return;
+	}
+
 	if(unlikely(fossil_is_needed(lp))) {
 		auto_ckpt_recompute(&lp->auto_ckpt, lp->mm_state.full_ckpt_size);
 		fossil_lp_collect(lp);
 		lp->p.bound = unlikely(array_is_empty(lp->p.p_msgs)) ? -1.0 : lp->p.bound;
 	}
 
-	uint32_t flags = atomic_fetch_add_explicit(&msg->flags, MSG_FLAG_PROCESSED, memory_order_relaxed);
-	if(unlikely(flags & MSG_FLAG_ANTI)) {
-		handle_anti_msg(lp, msg, flags);
-		lp->p.bound = unlikely(array_is_empty(lp->p.p_msgs)) ? -1.0 : lp->p.bound;
-		return;
-	}
+	t = timer_hr_new();
+	simtime_t last_t = -1.0;
+	unsigned n = 0;
+	do {
+		gvt_on_msg_extraction(msg->dest_t);
+
+		uint32_t flags = atomic_fetch_add_explicit(&msg->flags, MSG_FLAG_PROCESSED, memory_order_relaxed);
+		if(unlikely(flags & MSG_FLAG_ANTI)) {
+			if(n)
+				process_run_end(lp, t, last_t);
+			handle_anti_msg(lp, msg, flags);
+			lp->p.bound = unlikely(array_is_empty(lp->p.p_msgs)) ? -1.0 : lp->p.bound;
+			return;
+		}
 
-	if(unlikely(flags && lp->p.early_antis && check_early_anti_messages(&lp->p, msg)))
-		return;
+		if(unlikely(flags && hmap_count(&lp->p.early_antis) && check_early_anti_messages(&lp->p, msg)))
+			break;
 
-	if(unlikely(lp->p.bound >= msg->dest_t && msg_is_before(msg, array_peek(lp->p.p_msgs))))
-		handle_straggler_msg(lp, msg);
+		// with the hybrid synchronization, an LP not rolled back in the last GVTs processes its safe messages
+		// in the conservative mode
+		if(unlikely(lp->p.conservative)) {
+			if(msg->dest_t >= throttle_safe_bound)
+				process_mode_optimistic(lp);
+		} else {
+			if(unlikely(lp->p.bound >= msg->dest_t && msg_is_before(msg, array_peek(lp->p.p_msgs))))
+				handle_straggler_msg(lp, msg);
+			if(unlikely(msg->dest_t < throttle_safe_bound) && process_is_quiet(lp))
+				process_mode_conservative(lp);
+		}
 
 #ifndef NDEBUG
-	current_msg = msg;
+		current_msg = msg;
 #endif
 
-	common_msg_process(lp, msg);
-	lp->p.bound = msg->dest_t;
-	array_push(lp->p.p_msgs, msg);
-
-	auto_ckpt_register_good(&lp->auto_ckpt);
-	if(auto_ckpt_is_needed(&lp->auto_ckpt))
-		checkpoint_take(lp);
+		if(global_config.reverse_dispatcher != NULL && !lp->p.conservative)
+			array_push(lp->p.r_marks, bitlog_end(&lp->p.r_log));
+		common_msg_process(lp, msg);
+		if(unlikely(!array_is_empty(lp->p.cancels)))
+			lazy_cancels_flush(&lp->p, msg);
+		last_t = msg->dest_t;
+		if(unlikely(lp->p.conservative)) {
+			stats_take(STATS_MSG_SAFE, 1);
+			msg_allocator_free(msg);
+			continue;
+		}
+		lp->p.bound = msg->dest_t;
+		process_msg_push(&lp->p, msg);
+		auto_ckpt_register_good(&lp->auto_ckpt);
+	} while(++n < PROCESS_RUN_MAX && (msg = msg_queue_extract_lp(lp - lps, throttle_bound)) != NULL);
 
-	termination_on_msg_process(lp, msg->dest_t);
+	if(n)
+		process_run_end(lp, t, last_t);
 }
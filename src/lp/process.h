@@ -11,18 +11,43 @@
 #pragma once
 
 #include <datatypes/array.h>
+#include <datatypes/bitlog.h>
+#include <datatypes/hmap.h>
 #include <lp/msg.h>
 
+/// A message sent by a rolled back event, whose annihilation has been deferred by the lazy cancellation
+struct process_cancel {
+	/// The sent message, marked as in the processed messages array
+	struct lp_msg *msg;
+	/// The rolled back event which sent the message
+	const struct lp_msg *gen;
+};
+
 /// The message processing data produced by the LP
 struct process_ctx {
 	/// The messages processed in the past by the owner LP
 	dyn_array(struct lp_msg *) p_msgs;
-	/// The list of remote anti-messages delivered before their original counterpart
-	/** Hopefully this is 99.9% of the time empty */
-	struct lp_msg *early_antis;
+	/// The positions of the processed messages in #p_msgs, offset by #p_base and indexed by their identity
+	struct hmap p_index;
+	/// The count of messages removed from the head of #p_msgs by the fossil collection since the LP initialization
+	uint64_t p_base;
+	/// The messages sent by the rolled back events which may be sent again once those events are processed again
+	dyn_array(struct process_cancel) cancels;
+	/// The remote anti-messages delivered before their original counterpart, indexed by the identity of the latter
+	/** Hopefully this is 99.9% of the time empty, the stale entries are reclaimed by the fossil collection */
+	struct hmap early_antis;
+	/// The information logged by the model to undo the processed messages, used with the reverse computation
+	struct bitlog r_log;
+	/// The end of #r_log before each processed message in #p_msgs was processed, used with the reverse computation
+	dyn_array(uint64_t) r_marks;
 	/// The current logical time at which this LP is
 	/** This is lazily updated and not always accurate; it's sufficient for faster straggler detection */
 	simtime_t bound;
+	/// The fossil collection epoch in which the LP last rolled back, used to tell if the LP is quiet
+	unsigned rollback_epoch;
+	/// If set, the LP only processes safe messages, so it logs neither them nor its checkpoints
+	/** This is always set in the conservative mode; with the hybrid synchronization it is set for the quiet LPs */
+	bool conservative;
 };
 
 #define is_msg_sent(msg_p) (((uintptr_t)(msg_p)) & 3U)
@@ -31,6 +56,36 @@ struct process_ctx {
 #define is_msg_past(msg_p) (!(((uintptr_t)(msg_p)) & 3U))
 #define unmark_msg(msg_p) ((struct lp_msg *)(((uintptr_t)(msg_p)) & (UINTPTR_MAX - 3)))
 
+/**
+ * @brief Compute the identity of a local message in the processed messages index
+ * @param msg_p a pointer to the message
+ * @return the key of the message, which is its address
+ */
+#define process_key_local(msg_p) ((uint64_t)(uintptr_t)(msg_p))
+
+/**
+ * @brief Compute the identity of a remote message in the processed messages index
+ * @param msg_p a pointer to the message
+ * @return the key of the message, built from the unique id and the sequence number which anti-messages carry
+ *
+ * The key is odd, so that it never collides with the address of a local message.
+ */
+#define process_key_remote(msg_p) (((uint64_t)(msg_p)->m_seq << 32) | ((msg_p)->raw_flags & ~3U) | 1U)
+
+/**
+ * @brief Remove a processed message from the processed messages index
+ * @param proc_p the message processing data of the LP which processed the message
+ * @param msg the processed message
+ *
+ * Once a message has been processed, its flags aren't enough to reliably tell whether it is a local or a remote one, so
+ * both keys are tried.
+ */
+static inline void process_index_remove(struct process_ctx *proc_p, const struct lp_msg *msg)
+{
+	if(!hmap_remove(&proc_p->p_index, process_key_local(msg)))
+		hmap_remove(&proc_p->p_index, process_key_remote(msg));
+}
+
 struct lp_ctx; // forward declaration
 
 extern void process_lp_init(struct lp_ctx *lp);
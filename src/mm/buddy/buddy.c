@@ -19,6 +19,18 @@ void buddy_init(struct buddy_state *self)
 		self->longest[i] = node_size;
 		node_size -= is_power_of_2(i + 2);
 	}
+#ifdef ROOTSIM_INCREMENTAL
+#ifdef ROOTSIM_INCREMENTAL_MPROTECT
+	// the memory buffer isn't write-protected until the next checkpoint, so it is all saved in that one
+	uint_fast32_t d = (1 << (B_TOTAL_EXP - 2 * B_BLOCK_EXP + 1)) + (1 << (B_TOTAL_EXP - B_BLOCK_EXP));
+#else
+	// the whole allocation tree is new, while the memory buffer content is meaningless until written
+	uint_fast32_t d = 1 << (B_TOTAL_EXP - 2 * B_BLOCK_EXP + 1);
+#endif
+	memset(self->dirty, 0, sizeof(self->dirty));
+	for(uint_fast32_t i = 0; i < d; ++i)
+		bitmap_set(self->dirty, i);
+#endif
 }
 
 void *buddy_malloc(struct buddy_state *self, uint_fast8_t req_blks_exp)
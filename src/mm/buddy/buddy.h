@@ -19,6 +19,17 @@
 #define B_TOTAL_EXP 16U
 #define B_BLOCK_EXP 6U
 
+#if defined(ROOTSIM_INCREMENTAL_MPROTECT) || defined(ROOTSIM_COW_CHECKPOINTS)
+/// Defined if the buddy systems are write-protected to intercept the writes to their memory
+#define BUDDY_WPROTECT
+/// The exponent of the size of the pages write-protected to intercept the writes to the memory buffer
+#define B_PAGE_EXP 12U
+/// The alignment of the memory buffer, which must start at a page boundary to be write-protected
+#define B_MEM_ALIGN (1U << B_PAGE_EXP)
+#else
+#define B_MEM_ALIGN 16
+#endif
+
 #define next_exp_of_2(i) (sizeof(i) * CHAR_BIT - intrinsics_clz(i))
 #define buddy_allocation_block_compute(req_size) next_exp_of_2(max(req_size, 1U << B_BLOCK_EXP) - 1);
 
@@ -28,11 +39,15 @@
 
 /// The checkpointable memory context of a single buddy system
 struct buddy_state {
+#ifdef BUDDY_WPROTECT
+	/// Moves @a longest right before the page boundary at which @a base_mem starts
+	unsigned char pad[B_MEM_ALIGN - (1U << (B_TOTAL_EXP - B_BLOCK_EXP + 1))];
+#endif
 	/// The checkpointed binary tree representing the buddy system
 	/** the last char is actually unused */
 	alignas(16) uint8_t longest[(1U << (B_TOTAL_EXP - B_BLOCK_EXP + 1))];
 	/// The memory buffer served to the model
-	alignas(16) unsigned char base_mem[1U << B_TOTAL_EXP];
+	alignas(B_MEM_ALIGN) unsigned char base_mem[1U << B_TOTAL_EXP];
 	/// Keeps track of memory blocks which have been dirtied by a write
 	block_bitmap dirty[
 		bitmap_required_size(
@@ -40,99 +40,134 @@
 		}                                                                                                      \
 	})
 
-// TODO: fix incremental checkpointing
 #ifdef ROOTSIM_INCREMENTAL
 
-struct buddy_checkpoint *checkpoint_incremental_take(const struct buddy_state *self)
-{
-	uint_fast32_t bset = bitmap_count_set(self->dirty, sizeof(self->dirty));
+/// The count of bits in the dirty bitmap tracking the allocation tree, the memory buffer ones follow them
+#define B_TREE_CHUNKS (1U << (B_TOTAL_EXP - 2 * B_BLOCK_EXP + 1))
 
-	struct buddy_checkpoint *ret = mm_alloc(offsetof(struct buddy_checkpoint, longest) + bset * (1 << B_BLOCK_EXP));
+/**
+ * @brief Take an incremental checkpoint of a buddy system
+ * @param self the buddy system to checkpoint
+ * @param ret the memory area where the checkpoint is written, at least checkpoint_incremental_size() bytes large
+ * @return a pointer to the first byte past the written checkpoint
+ *
+ * Only the 64 bytes chunks written since the last checkpoint, as tracked in the dirty bitmap, are saved. The dirty
+ * bitmap is then cleared.
+ */
+struct buddy_checkpoint *checkpoint_incremental_take(struct buddy_state *self, struct buddy_checkpoint *ret)
+{
+	ret->orig = self;
+	memcpy(ret->dirty, self->dirty, sizeof(self->dirty));
 
+	// longest[] and base_mem[] are contiguous, so the chunks of both are indexed from the start of longest[]
 	unsigned char *ptr = ret->longest;
 	const unsigned char *src = self->longest;
 
-#define copy_block_to_ckp(i)                                                                                           \
+#define buddy_chunk_copy_to_ckp(i)                                                                                     \
 	__extension__({                                                                                                \
-		memcpy(ptr, src + ((i) << B_BLOCK_EXP), 1 << B_BLOCK_EXP);                                             \
-		ptr += 1 << B_BLOCK_EXP;                                                                               \
+		memcpy(ptr, src + ((i) << B_BLOCK_EXP), 1U << B_BLOCK_EXP);                                            \
+		ptr += 1U << B_BLOCK_EXP;                                                                              \
 	})
 
-	bitmap_foreach_set(self->dirty, sizeof(self->dirty), copy_block_to_ckp);
-#undef copy_block_to_ckp
+	bitmap_foreach_set(self->dirty, sizeof(self->dirty), buddy_chunk_copy_to_ckp);
 
-	memcpy(ret->dirty, self->dirty, sizeof(self->dirty));
-	return ret;
+#undef buddy_chunk_copy_to_ckp
+	memset(self->dirty, 0, sizeof(self->dirty));
+	return (struct buddy_checkpoint *)ptr;
 }
 
-void checkpoint_incremental_restore(struct buddy_state *self, const struct buddy_checkpoint *ckp)
+/**
+ * @brief Restore the chunks of a buddy system held in an incremental checkpoint
+ * @param self the buddy system to restore, whose dirty bitmap holds the chunks still to be restored
+ * @param ckp the incremental checkpoint of @p self
+ * @return a pointer to the checkpoint of the next buddy system in the sequence
+ *
+ * The restored chunks are cleared from the dirty bitmap of @p self, so that older checkpoints won't overwrite them.
+ */
+const struct buddy_checkpoint *checkpoint_incremental_restore(struct buddy_state *self,
+    const struct buddy_checkpoint *ckp)
 {
-	array_count_t i = array_count(self->logs) - 1;
-	const struct buddy_checkpoint *cur_ckp = array_get_at(self->logs, i).c;
+	const unsigned char *ptr = ckp->longest;
+	unsigned char *dst = self->longest;
 
-	while(cur_ckp != ckp) {
-		bitmap_merge_or(self->dirty, cur_ckp->dirty, sizeof(self->dirty));
-		cur_ckp = array_get_at(self->logs, --i).c;
-	}
-
-#define copy_dirty_block(i)                                                                                            \
+#define buddy_chunk_copy_from_ckp(i)                                                                                   \
 	__extension__({                                                                                                \
 		if(bitmap_check(self->dirty, i)) {                                                                     \
-			memcpy(self->longest + (i << B_BLOCK_EXP), ptr, 1 << B_BLOCK_EXP);                             \
+			memcpy(dst + ((i) << B_BLOCK_EXP), ptr, 1U << B_BLOCK_EXP);                                    \
 			bitmap_reset(self->dirty, i);                                                                  \
-			--r;                                                                                           \
 		}                                                                                                      \
-		ptr += 1 << B_BLOCK_EXP;                                                                               \
+		ptr += 1U << B_BLOCK_EXP;                                                                              \
 	})
 
-#define copy_block_from_ckp(i)                                                                                         \
-	__extension__({                                                                                                \
-		memcpy(self->longest + (i << B_BLOCK_EXP), cur_ckp->longest + (i << B_BLOCK_EXP), 1 << B_BLOCK_EXP);   \
-		--r;                                                                                                   \
-	})
+	bitmap_foreach_set(ckp->dirty, sizeof(ckp->dirty), buddy_chunk_copy_from_ckp);
 
-#define buddy_block_dirty_from_ckp(offset, len)                                                                        \
-	__extension__({                                                                                                \
-		uint_fast32_t i = (offset >> B_BLOCK_EXP) + (1 << (B_TOTAL_EXP - 2 * B_BLOCK_EXP + 1));                \
-		uint_fast32_t b_len = len;                                                                             \
-		do {                                                                                                   \
-			copy_dirty_block(i);                                                                           \
-			i++;                                                                                           \
-			b_len -= 1U << B_BLOCK_EXP;                                                                    \
-		} while(b_len);                                                                                        \
-	})
+#undef buddy_chunk_copy_from_ckp
+	return (const struct buddy_checkpoint *)ptr;
+}
 
-	uint_fast32_t r = bitmap_count_set(self->dirty, sizeof(self->dirty));
-	const unsigned char *ptr = cur_ckp->longest;
+/**
+ * @brief Restore the chunks of a buddy system which are still dirty from a full checkpoint
+ * @param self the buddy system to restore, whose dirty bitmap holds the chunks still to be restored
+ * @param ckp the full checkpoint of @p self
+ * @return a pointer to the checkpoint of the next buddy system in the sequence
+ *
+ * This ends the restore chain started from an incremental checkpoint: the dirty chunks not held in @p ckp belonged to
+ * memory blocks which were free at the time, so their content is irrelevant.
+ */
+const struct buddy_checkpoint *checkpoint_full_dirty_restore(struct buddy_state *self,
+    const struct buddy_checkpoint *ckp)
+{
+	for(uint_fast32_t i = 0; i < B_TREE_CHUNKS; ++i)
+		if(bitmap_check(self->dirty, i))
+			memcpy(self->longest + (i << B_BLOCK_EXP), ckp->longest + (i << B_BLOCK_EXP),
+			    1U << B_BLOCK_EXP);
 
-	bitmap_foreach_set(cur_ckp->dirty, sizeof(cur_ckp->dirty), copy_dirty_block);
+#define buddy_block_dirty_copy_from_ckp(offset, len)                                                                   \
+	__extension__({                                                                                                \
+		uint_fast32_t __c = ((offset) >> B_BLOCK_EXP) + B_TREE_CHUNKS;                                         \
+		for(uint_fast32_t __p = (offset); __p < (offset) + (len); __p += 1U << B_BLOCK_EXP, ++__c) {           \
+			if(bitmap_check(self->dirty, __c))                                                             \
+				memcpy(self->base_mem + __p, ptr, 1U << B_BLOCK_EXP);                                  \
+			ptr += 1U << B_BLOCK_EXP;                                                                      \
+		}                                                                                                      \
+	})
 
-	const unsigned tree_bit_size = bitmap_required_size(1 << (B_TOTAL_EXP - 2 * B_BLOCK_EXP + 1));
+	const unsigned char *ptr = ckp->base_mem;
+	buddy_tree_visit(ckp->longest, buddy_block_dirty_copy_from_ckp);
 
-	while(r) {
-		cur_ckp = array_get_at(self->logs, --i).c;
-		if(cur_ckp->is_incremental) {
-			ptr = cur_ckp->longest;
-			bitmap_foreach_set(cur_ckp->dirty, sizeof(cur_ckp->dirty), copy_dirty_block);
-		} else {
-			bitmap_foreach_set(self->dirty, tree_bit_size, copy_block_from_ckp);
-			ptr = cur_ckp->base_mem;
-			buddy_tree_visit(cur_ckp->longest, buddy_block_dirty_from_ckp);
-		}
-	}
+#undef buddy_block_dirty_copy_from_ckp
+	memset(self->dirty, 0, sizeof(self->dirty));
+	return (const struct buddy_checkpoint *)ptr;
+}
 
-#undef copy_dirty_block
-#undef copy_block_from_ckp
-#undef buddy_block_dirty_from_ckp
+/**
+ * @brief Get the checkpoint of the next buddy system in a sequence
+ * @param ckp the checkpoint of a buddy system
+ * @param incremental true if @p ckp is an incremental checkpoint, false if it is a full one
+ * @return a pointer to the checkpoint following @p ckp
+ */
+const struct buddy_checkpoint *checkpoint_next(const struct buddy_checkpoint *ckp, bool incremental)
+{
+	if(incremental)
+		return (const struct buddy_checkpoint *)(ckp->longest +
+		    (bitmap_count_set(ckp->dirty, sizeof(ckp->dirty)) << B_BLOCK_EXP));
+
+	uint_fast32_t size = 0;
+#define buddy_block_size_add(offset, len) ((void)(offset), size += (len))
+	buddy_tree_visit(ckp->longest, buddy_block_size_add);
+#undef buddy_block_size_add
+	return (const struct buddy_checkpoint *)(ckp->base_mem + size);
 }
 
 #endif
 
-struct buddy_checkpoint *checkpoint_full_take(const struct buddy_state *self, struct buddy_checkpoint *ret)
+struct buddy_checkpoint *checkpoint_full_take(struct buddy_state *self, struct buddy_checkpoint *ret)
 {
 	ret->orig = self;
 #ifdef ROOTSIM_INCREMENTAL
+	// the written chunks are needed anyway, to know what to restore when rolling back past this checkpoint
 	memcpy(ret->dirty, self->dirty, sizeof(self->dirty));
+	memset(self->dirty, 0, sizeof(self->dirty));
 #endif
 	memcpy(ret->longest, self->longest, sizeof(ret->longest));
 
@@ -35,7 +35,23 @@ static_assert(
 	sizeof(((struct buddy_checkpoint *)0)->longest),
 	"longest and base_mem are not contiguous, this will break incremental checkpointing");
 
-extern struct buddy_checkpoint *checkpoint_full_take(const struct buddy_state *self, struct buddy_checkpoint *data);
+extern struct buddy_checkpoint *checkpoint_full_take(struct buddy_state *self, struct buddy_checkpoint *data);
 extern const struct buddy_checkpoint *checkpoint_full_restore(struct buddy_state *self, const struct buddy_checkpoint *data);
-extern struct buddy_checkpoint *checkpoint_incremental_take(const struct buddy_state *self, struct buddy_checkpoint *data);
-extern const struct buddy_checkpoint * checkpoint_incremental_restore(struct buddy_state *self, const struct buddy_checkpoint *ckp);
+
+#ifdef ROOTSIM_INCREMENTAL
+/**
+ * @brief Compute the size of an incremental checkpoint of a buddy system
+ * @param self the buddy system to checkpoint
+ * @return the count of bytes needed by checkpoint_incremental_take() to checkpoint @p self
+ */
+#define checkpoint_incremental_size(self)                                                                              \
+	(offsetof(struct buddy_checkpoint, longest) +                                                                  \
+	    (bitmap_count_set((self)->dirty, sizeof((self)->dirty)) << B_BLOCK_EXP))
+
+extern struct buddy_checkpoint *checkpoint_incremental_take(struct buddy_state *self, struct buddy_checkpoint *data);
+extern const struct buddy_checkpoint *checkpoint_incremental_restore(struct buddy_state *self,
+    const struct buddy_checkpoint *ckp);
+extern const struct buddy_checkpoint *checkpoint_full_dirty_restore(struct buddy_state *self,
+    const struct buddy_checkpoint *ckp);
+extern const struct buddy_checkpoint *checkpoint_next(const struct buddy_checkpoint *ckp, bool incremental);
+#endif
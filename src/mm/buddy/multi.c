@@ -8,40 +8,211 @@
  */
 #include <mm/buddy/multi.h>
 
+#include <arch/timer.h>
 #include <core/core.h>
 #include <core/intrinsics.h>
+#include <log/stats.h>
 #include <lp/lp.h>
 #include <mm/buddy/buddy.h>
 #include <mm/buddy/ckpt.h>
+#include <mm/ckpt_allocator.h>
 
 #include <errno.h>
 
+#ifdef BUDDY_WPROTECT
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #ifdef ROOTSIM_INCREMENTAL
+/// The maximum count of incremental checkpoints following a full one, which bounds the cost of a restore
+#define MAX_INCREMENTAL_CHAIN 16
 #define is_log_incremental(l) ((uintptr_t)(l).c & 0x1)
+#define log_checkpoint(l) ((struct mm_checkpoint *)((uintptr_t)(l).c & ~(uintptr_t)0x1))
 #else
 #define is_log_incremental(l) false
+#define log_checkpoint(l) ((l).c)
+#endif
+
+#ifdef BUDDY_WPROTECT
+#ifdef ROOTSIM_COW_CHECKPOINTS
+/// The start of the write-protected memory of a buddy system, the page holding the allocation tree is snapshotted too
+#define wprotect_start(b) ((unsigned char *)(b))
+#else
+/// The start of the write-protected memory of a buddy system, the writes to the allocation tree are tracked explicitly
+#define wprotect_start(b) ((b)->base_mem)
+#endif
+/// The end of the write-protected memory of a buddy system
+#define wprotect_end(b) ((b)->base_mem + sizeof((b)->base_mem))
+/// The count of pages in the write-protected memory of a buddy system
+#define wprotect_pages(b) ((array_count_t)((wprotect_end(b) - wprotect_start(b)) >> B_PAGE_EXP))
+
+/// The action handling the segmentation faults before wprotect_fault_handle() was installed
+static struct sigaction wprotect_old_action;
+
+/**
+ * @brief Write-protect or write-enable the memory of a buddy system
+ * @param b the target buddy system
+ * @param prot PROT_READ to intercept the next writes to the memory, PROT_READ | PROT_WRITE to stop intercepting them
+ */
+static void wprotect_set(struct buddy_state *b, int prot)
+{
+	if(unlikely(mprotect(wprotect_start(b), wprotect_end(b) - wprotect_start(b), prot))) {
+		logger(LOG_FATAL, "Unable to change the protection of the LP memory");
+		abort();
+	}
+}
+
+/**
+ * @brief Handle a write to a write-protected page of the memory of the current LP
+ * @param sig the number of the delivered signal, always SIGSEGV
+ * @param info the information about the fault, including the faulting address
+ * @param uctx the context of the interrupted thread
+ *
+ * The written page is marked dirty, or copied in the last checkpoint with the copy-on-write checkpoints, and then
+ * write-enabled, so that the interrupted write is completed once this handler returns. Faults hitting something else
+ * than the memory of the current LP are handed back to the previous handler. Since this runs in a signal handler, it
+ * never allocates memory: the page copies use the buffers set aside by cow_pages_reserve().
+ */
+static void wprotect_fault_handle(int sig, siginfo_t *info, void *uctx)
+{
+	(void)sig;
+	(void)uctx;
+	const unsigned char *ptr = info->si_addr;
+	struct buddy_state *b = NULL;
+
+	if(likely(current_lp != NULL)) {
+		struct mm_state *self = &current_lp->mm_state;
+		array_count_t l = 0, h = array_count(self->buddies);
+		while(l < h) {
+			array_count_t m = (l + h) / 2;
+			struct buddy_state *c = array_get_at(self->buddies, m);
+			if(ptr < wprotect_start(c)) {
+				h = m;
+			} else if(ptr >= wprotect_end(c)) {
+				l = m + 1;
+			} else {
+				b = c;
+				break;
+			}
+		}
+	}
+
+	if(unlikely(b == NULL)) {
+		// the faulting instruction is executed again, this time under the previous handler
+		sigaction(SIGSEGV, &wprotect_old_action, NULL);
+		return;
+	}
+
+	unsigned p = (uintptr_t)(ptr - wprotect_start(b)) >> B_PAGE_EXP;
+	unsigned char *page = wprotect_start(b) + ((uintptr_t)p << B_PAGE_EXP);
+#ifdef ROOTSIM_COW_CHECKPOINTS
+	// the page copy is the deferred part of the last checkpoint, so its cost is accounted as checkpointing
+	timer_uint t = timer_hr_new();
+	struct mm_state *self = &current_lp->mm_state;
+	struct mm_page_copy copy = {.b = b, .page = p, .data = array_pop(self->spare_pages)};
+	memcpy(copy.data, page, 1U << B_PAGE_EXP);
+	// the room for the copy has been reserved as well, so this never reallocates the array
+	struct mm_checkpoint *ckp = array_peek(self->logs).c;
+	array_get_at(ckp->pages, array_count(ckp->pages)++) = copy;
+	stats_take(STATS_CKPT_SAVED, 1U << B_PAGE_EXP);
+	stats_take(STATS_CKPT_TIME, timer_hr_value(t));
+#else
+	buddy_dirty_mark(b, page, 1U << B_PAGE_EXP);
+#endif
+	mprotect(page, 1U << B_PAGE_EXP, PROT_READ | PROT_WRITE);
+}
+#endif
+
+/**
+ * @brief Initialize the global data structures of the model memory allocator
+ */
+void model_allocator_global_init(void)
+{
+#ifdef BUDDY_WPROTECT
+	if(sysconf(_SC_PAGESIZE) > (1L << B_PAGE_EXP)) {
+		logger(LOG_FATAL, "The page size is larger than %u bytes, the LP memory can't be write-protected",
+		    1U << B_PAGE_EXP);
+		abort();
+	}
+
+	struct sigaction act = {.sa_sigaction = wprotect_fault_handle, .sa_flags = SA_SIGINFO | SA_RESTART};
+	sigemptyset(&act.sa_mask);
+	if(sigaction(SIGSEGV, &act, &wprotect_old_action)) {
+		logger(LOG_FATAL, "Unable to install the write-protection fault handler");
+		abort();
+	}
+#endif
+}
+
+/**
+ * @brief Finalize the global data structures of the model memory allocator
+ */
+void model_allocator_global_fini(void)
+{
+#ifdef BUDDY_WPROTECT
+	sigaction(SIGSEGV, &wprotect_old_action, NULL);
+#endif
+}
+
+/**
+ * @brief Free a checkpoint
+ * @param l the log of the checkpoint to free
+ */
+static void log_free(const struct mm_log *l)
+{
+	struct mm_checkpoint *ckp = log_checkpoint(*l);
+#ifdef ROOTSIM_COW_CHECKPOINTS
+	array_count_t i = array_count(ckp->pages);
+	while(i--)
+		if(array_get_at(ckp->pages, i).data != NULL)
+			ckpt_allocator_free(array_get_at(ckp->pages, i).data);
+	array_fini(ckp->pages);
 #endif
+	ckpt_allocator_free(ckp);
+}
 
 void model_allocator_lp_init(struct mm_state *self)
 {
 	array_init(self->buddies);
 	array_init(self->logs);
 	self->full_ckpt_size = offsetof(struct mm_checkpoint, chkps) + sizeof(struct buddy_state *);
+#ifdef ROOTSIM_INCREMENTAL
+	self->inc_count = 0;
+	self->force_full = true;
+#endif
+#ifdef ROOTSIM_COW_CHECKPOINTS
+	array_init(self->spare_pages);
+#endif
 }
 
 void model_allocator_lp_fini(struct mm_state *self)
 {
 	array_count_t i = array_count(self->logs);
 	while(i--)
-		mm_free(array_get_at(self->logs, i).c);
+		log_free(&array_get_at(self->logs, i));
 
 	array_fini(self->logs);
 
-	i = array_count(self->buddies);
+#ifdef ROOTSIM_COW_CHECKPOINTS
+	i = array_count(self->spare_pages);
 	while(i--)
-		mm_free(array_get_at(self->buddies, i));
+		ckpt_allocator_free(array_get_at(self->spare_pages, i));
+	array_fini(self->spare_pages);
+#endif
+
+	i = array_count(self->buddies);
+	while(i--) {
+#ifdef BUDDY_WPROTECT
+		wprotect_set(array_get_at(self->buddies, i), PROT_READ | PROT_WRITE);
+#endif
+		mm_aligned_free(array_get_at(self->buddies, i));
+	}
 
 	array_fini(self->buddies);
+	// the cached buffer may have just been freed
+	__write_mem_cache.size = 0;
 }
 
 void *rs_malloc(size_t req_size)
@@ -66,7 +237,7 @@ void *rs_malloc(size_t req_size)
 			return ret;
 	}
 
-	struct buddy_state *new_buddy = mm_alloc(sizeof(*new_buddy));
+	struct buddy_state *new_buddy = mm_aligned_alloc(alignof(struct buddy_state), sizeof(*new_buddy));
 	buddy_init(new_buddy);
 
 	for(i = 0; i < array_count(self->buddies); ++i)
@@ -75,6 +246,16 @@ void *rs_malloc(size_t req_size)
 
 	array_add_at(self->buddies, i, new_buddy);
 	self->full_ckpt_size += offsetof(struct buddy_checkpoint, base_mem);
+#ifdef ROOTSIM_COW_CHECKPOINTS
+	// the new buddy system is write-protected from the next checkpoint, a rollback before that one resets it
+	if(likely(!array_is_empty(self->logs))) {
+		struct mm_page_copy copy = {.b = new_buddy, .page = 0, .data = NULL};
+		struct mm_checkpoint *ckp = array_peek(self->logs).c;
+		// keeps the room for the copies of the pages still write-protected, see cow_pages_reserve()
+		array_reserve(ckp->pages, array_count(self->spare_pages) + 1);
+		array_push(ckp->pages, copy);
+	}
+#endif
 	return buddy_malloc(new_buddy, req_blks_exp);
 }
 
@@ -83,8 +264,12 @@ void *rs_calloc(size_t nmemb, size_t size)
 	size_t tot = nmemb * size;
 	void *ret = rs_malloc(tot);
 
-	if(likely(ret))
+	if(likely(ret)) {
 		memset(ret, 0, tot);
+#ifdef ROOTSIM_INCREMENTAL
+		__write_mem(ret, tot);
+#endif
+	}
 
 	return ret;
 }
@@ -137,29 +322,276 @@ void *rs_realloc(void *ptr, size_t req_size)
 		return NULL;
 
 	memcpy(new_buffer, ptr, min(req_size, ret.original));
+#ifdef ROOTSIM_INCREMENTAL
+	__write_mem(new_buffer, min(req_size, ret.original));
+#endif
 	rs_free(ptr);
 
 	return new_buffer;
 }
 
-void __write_mem(const void *ptr, size_t s)
+/**
+ * @brief Find the buddy system whose memory holds an address, if any
+ * @param self the memory context to search
+ * @param ptr the address to look for
+ * @return the buddy system serving @p ptr, NULL if @p ptr is outside the memory of all the buddy systems of @p self
+ */
+static struct buddy_state *buddy_lookup_by_address(const struct mm_state *self, const unsigned char *ptr)
+{
+	array_count_t l = 0, h = array_count(self->buddies);
+	while(l < h) {
+		array_count_t m = (l + h) / 2;
+		struct buddy_state *b = array_get_at(self->buddies, m);
+		if(ptr < b->base_mem)
+			h = m;
+		else if(ptr >= b->base_mem + sizeof(b->base_mem))
+			l = m + 1;
+		else
+			return b;
+	}
+	return NULL;
+}
+
+static_assert(RS_WRITE_CHUNK_EXP == B_BLOCK_EXP, "The write tracking chunks must be the buddy system blocks");
+
+__thread struct rs_write_cache __write_mem_cache;
+
+void __write_mem_slow(const void *ptr, size_t s)
 {
-	struct mm_state *self = &current_lp->mm_state;
-	if(unlikely(!s || array_is_empty(self->buddies)))
+	// the instrumented model code also runs outside of the LPs, in its main() for example
+	if(unlikely(current_lp == NULL || !s))
 		return;
 
-	if(unlikely(ptr < (void *)array_get_at(self->buddies, 0) || ptr > (void *)(array_peek(self->buddies) + 1)))
+	// the writes to other memory, such as the libc heap, are not checkpointed
+	struct buddy_state *b = buddy_lookup_by_address(&current_lp->mm_state, ptr);
+	if(unlikely(b == NULL))
 		return;
 
-	struct buddy_state *b = buddy_find_by_address(self, ptr);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	// the bits of the memory chunks start at a byte boundary and, in little endian, keep their place byte-wise
+	static_assert(!((1 << (B_TOTAL_EXP - 2 * B_BLOCK_EXP + 1)) % CHAR_BIT), "Misaligned dirty bitmap");
+	__write_mem_cache.base = b->base_mem;
+	__write_mem_cache.size = sizeof(b->base_mem);
+	__write_mem_cache.dirty = (unsigned char *)b->dirty + (1 << (B_TOTAL_EXP - 2 * B_BLOCK_EXP + 1)) / CHAR_BIT;
+#endif
 
-	buddy_dirty_mark(b, ptr, s);
+	size_t rem = (size_t)(b->base_mem + sizeof(b->base_mem) - (const unsigned char *)ptr);
+	buddy_dirty_mark(b, ptr, min(s, rem));
 }
 
-// todo: incremental
-void model_allocator_checkpoint_take(struct mm_state *self, array_count_t ref_i)
+#ifdef ROOTSIM_INCREMENTAL
+/**
+ * @brief Take an incremental checkpoint, if it is convenient
+ * @param self the memory context to checkpoint
+ * @param ref_i the reference index of the checkpoint
+ * @return the size of the taken checkpoint in bytes, 0 if a full checkpoint is needed instead
+ *
+ * A full checkpoint is preferred when it has been explicitly requested, when the restore chain is already long or when
+ * the incremental checkpoint wouldn't be smaller than half of a full one.
+ */
+static uint_fast32_t checkpoint_incremental_try(struct mm_state *self, array_count_t ref_i)
 {
-	struct mm_checkpoint *ckp = mm_alloc(self->full_ckpt_size);
+	if(self->force_full || self->inc_count >= MAX_INCREMENTAL_CHAIN)
+		return 0;
+
+	uint_fast32_t size = offsetof(struct mm_checkpoint, chkps) + sizeof(struct buddy_state *);
+	array_count_t i = array_count(self->buddies);
+	while(i--)
+		size += checkpoint_incremental_size(array_get_at(self->buddies, i));
+
+	if(size * 2 > self->full_ckpt_size)
+		return 0;
+
+	struct mm_checkpoint *ckp = ckpt_allocator_alloc(size);
+	ckp->ckpt_size = self->full_ckpt_size;
+
+	// the checkpoints are allocated with at least pointer alignment, so the lowest bit tags the incremental ones
+	struct mm_log mm_log = {.ref_i = ref_i, .c = (struct mm_checkpoint *)((uintptr_t)ckp | 0x1)};
+	array_push(self->logs, mm_log);
+
+	struct buddy_checkpoint *buddy_ckp = (struct buddy_checkpoint *)ckp->chkps;
+	i = array_count(self->buddies);
+	while(i--)
+		buddy_ckp = checkpoint_incremental_take(array_get_at(self->buddies, i), buddy_ckp);
+	buddy_ckp->orig = NULL;
+
+	++self->inc_count;
+#ifdef ROOTSIM_INCREMENTAL_MPROTECT
+	i = array_count(self->buddies);
+	while(i--)
+		wprotect_set(array_get_at(self->buddies, i), PROT_READ);
+#endif
+	return size;
+}
+
+/**
+ * @brief Restore the memory context from a checkpoint, chaining back to the last full checkpoint if needed
+ * @param self the memory context to restore
+ * @param i the index in @a self->logs of the checkpoint to restore
+ *
+ * The chunks to restore are the ones written after the target checkpoint: they are gathered in the dirty bitmaps of
+ * the buddy systems and each one is restored from the most recent checkpoint holding it, starting from the target.
+ */
+static void checkpoint_chain_restore(struct mm_state *self, array_count_t i)
+{
+#ifdef ROOTSIM_INCREMENTAL_MPROTECT
+	// the writes done by the restore itself must not be tracked
+	for(array_count_t k = 0; k < array_count(self->buddies); ++k)
+		wprotect_set(array_get_at(self->buddies, k), PROT_READ | PROT_WRITE);
+#endif
+	for(array_count_t j = array_count(self->logs) - 1; j > i; --j) {
+		const struct mm_log *l = &array_get_at(self->logs, j);
+		const struct buddy_checkpoint *c = (struct buddy_checkpoint *)log_checkpoint(*l)->chkps;
+		while(c->orig != NULL) {
+			struct buddy_state *b = (struct buddy_state *)c->orig;
+			bitmap_merge_or(b->dirty, c->dirty, sizeof(b->dirty));
+			c = checkpoint_next(c, is_log_incremental(*l));
+		}
+	}
+
+	// the buddy systems appearing in older checkpoints appear in the target one as well, they are never released
+	array_count_t j = i;
+	while(1) {
+		const struct mm_log *l = &array_get_at(self->logs, j);
+		const struct buddy_checkpoint *c = (struct buddy_checkpoint *)log_checkpoint(*l)->chkps;
+		if(!is_log_incremental(*l)) {
+			while(c->orig != NULL)
+				c = checkpoint_full_dirty_restore((struct buddy_state *)c->orig, c);
+			break;
+		}
+		while(c->orig != NULL)
+			c = checkpoint_incremental_restore((struct buddy_state *)c->orig, c);
+		--j;
+	}
+	self->inc_count = i - j;
+
+	const struct mm_log *l = &array_get_at(self->logs, i);
+	const struct buddy_checkpoint *buddy_ckp = (struct buddy_checkpoint *)log_checkpoint(*l)->chkps;
+	array_count_t k = array_count(self->buddies);
+	while(k--) {
+		struct buddy_state *b = array_get_at(self->buddies, k);
+		if(unlikely(buddy_ckp->orig != b)) {
+			buddy_init(b);
+			self->full_ckpt_size += offsetof(struct buddy_checkpoint, base_mem);
+		} else {
+			// the dirty chunks left were free at the time of the full checkpoint
+			memset(b->dirty, 0, sizeof(b->dirty));
+			buddy_ckp = checkpoint_next(buddy_ckp, is_log_incremental(*l));
+		}
+#ifdef ROOTSIM_INCREMENTAL_MPROTECT
+		wprotect_set(b, PROT_READ);
+#endif
+	}
+}
+#endif
+
+#ifdef ROOTSIM_COW_CHECKPOINTS
+/**
+ * @brief Set aside the memory needed to copy the pages of the LP memory once it is write-protected
+ * @param self the memory context about to be write-protected
+ * @param ckp the checkpoint which will hold the page copies
+ *
+ * wprotect_fault_handle() can't allocate memory, since the libc allocator isn't async-signal-safe. Each page is copied
+ * at most once before the memory is write-protected again, so a spare buffer for each page and the room for as many
+ * copies in @p ckp are enough. The spare buffers are kept from a checkpoint to the next, so only the ones consumed in
+ * the meanwhile are replaced.
+ */
+static void cow_pages_reserve(struct mm_state *self, struct mm_checkpoint *ckp)
+{
+	array_count_t n = 0;
+	for(array_count_t i = 0; i < array_count(self->buddies); ++i)
+		n += wprotect_pages(array_get_at(self->buddies, i));
+
+	while(array_count(self->spare_pages) < n)
+		array_push(self->spare_pages, ckpt_allocator_alloc(1U << B_PAGE_EXP));
+	array_reserve(ckp->pages, n);
+}
+
+/**
+ * @brief Take a copy-on-write checkpoint
+ * @param self the memory context to checkpoint
+ * @param ref_i the reference index of the checkpoint
+ * @return the size of the checkpoint in bytes, not counting the pages copied later on
+ *
+ * Nothing is copied here: the memory of the buddy systems is write-protected and each page is copied in the checkpoint
+ * by wprotect_fault_handle(), right before its first write. The time and the bytes of those copies are accounted to
+ * the checkpointing statistics there.
+ */
+static uint_fast32_t checkpoint_cow_take(struct mm_state *self, array_count_t ref_i)
+{
+	struct mm_checkpoint *ckp = ckpt_allocator_alloc(sizeof(*ckp));
+	ckp->ckpt_size = self->full_ckpt_size;
+	array_init(ckp->pages);
+
+	struct mm_log mm_log = {.ref_i = ref_i, .c = ckp};
+	array_push(self->logs, mm_log);
+
+	cow_pages_reserve(self, ckp);
+	array_count_t i = array_count(self->buddies);
+	while(i--)
+		wprotect_set(array_get_at(self->buddies, i), PROT_READ);
+	return sizeof(*ckp);
+}
+
+/**
+ * @brief Restore the memory context from a copy-on-write checkpoint
+ * @param self the memory context to restore
+ * @param i the index in @a self->logs of the checkpoint to restore
+ *
+ * The pages copied in the checkpoints from the last one back to the target are written back, undoing the writes which
+ * happened in the meanwhile. The target checkpoint then starts over collecting the pages written from now on.
+ */
+static void checkpoint_cow_restore(struct mm_state *self, array_count_t i)
+{
+	// the writes done by the restore itself must not be intercepted
+	for(array_count_t k = 0; k < array_count(self->buddies); ++k)
+		wprotect_set(array_get_at(self->buddies, k), PROT_READ | PROT_WRITE);
+
+	array_count_t j = array_count(self->logs);
+	while(j-- > i) {
+		struct mm_checkpoint *ckp = array_get_at(self->logs, j).c;
+		array_count_t k = array_count(ckp->pages);
+		while(k--) {
+			struct mm_page_copy *c = &array_get_at(ckp->pages, k);
+			if(c->data == NULL) {
+				buddy_init(c->b);
+				self->full_ckpt_size += offsetof(struct buddy_checkpoint, base_mem);
+			} else {
+				memcpy((unsigned char *)c->b + ((uintptr_t)c->page << B_PAGE_EXP), c->data,
+				    1U << B_PAGE_EXP);
+			}
+		}
+	}
+
+	struct mm_checkpoint *ckp = array_get_at(self->logs, i).c;
+	array_count_t k = array_count(ckp->pages);
+	while(k--)
+		if(array_get_at(ckp->pages, k).data != NULL)
+			ckpt_allocator_free(array_get_at(ckp->pages, k).data);
+	array_count(ckp->pages) = 0;
+	// the buddy systems reset above are part of the target checkpoint from now on
+	ckp->ckpt_size = self->full_ckpt_size;
+
+	cow_pages_reserve(self, ckp);
+	for(k = 0; k < array_count(self->buddies); ++k)
+		wprotect_set(array_get_at(self->buddies, k), PROT_READ);
+}
+#endif
+
+uint_fast32_t model_allocator_checkpoint_take(struct mm_state *self, array_count_t ref_i)
+{
+#ifdef ROOTSIM_COW_CHECKPOINTS
+	return checkpoint_cow_take(self, ref_i);
+#else
+#ifdef ROOTSIM_INCREMENTAL
+	uint_fast32_t inc_size = checkpoint_incremental_try(self, ref_i);
+	if(inc_size)
+		return inc_size;
+
+	self->force_full = false;
+	self->inc_count = 0;
+#endif
+	struct mm_checkpoint *ckp = ckpt_allocator_alloc(self->full_ckpt_size);
 	ckp->ckpt_size = self->full_ckpt_size;
 
 	struct mm_log mm_log = {.ref_i = ref_i, .c = ckp};
@@ -170,12 +602,22 @@ void model_allocator_checkpoint_take(struct mm_state *self, array_count_t ref_i)
 	while(i--)
 		buddy_ckp = checkpoint_full_take(array_get_at(self->buddies, i), buddy_ckp);
 	buddy_ckp->orig = NULL;
+#ifdef ROOTSIM_INCREMENTAL_MPROTECT
+	i = array_count(self->buddies);
+	while(i--)
+		wprotect_set(array_get_at(self->buddies, i), PROT_READ);
+#endif
+	return self->full_ckpt_size;
+#endif
 }
 
 void model_allocator_checkpoint_next_force_full(struct mm_state *self)
 {
+#ifdef ROOTSIM_INCREMENTAL
+	self->force_full = true;
+#else
 	(void)self;
-	// TODO: force full checkpointing when incremental state saving is enabled
+#endif
 }
 
 array_count_t model_allocator_checkpoint_restore(struct mm_state *self, array_count_t ref_i)
@@ -184,8 +626,13 @@ array_count_t model_allocator_checkpoint_restore(struct mm_state *self, array_co
 	while(array_get_at(self->logs, i).ref_i > ref_i)
 		i--;
 
-	struct mm_checkpoint *ckp = array_get_at(self->logs, i).c;
+	struct mm_checkpoint *ckp = log_checkpoint(array_get_at(self->logs, i));
 	self->full_ckpt_size = ckp->ckpt_size;
+#ifdef ROOTSIM_INCREMENTAL
+	checkpoint_chain_restore(self, i);
+#elif defined(ROOTSIM_COW_CHECKPOINTS)
+	checkpoint_cow_restore(self, i);
+#else
 	const struct buddy_checkpoint *buddy_ckp = (struct buddy_checkpoint *)ckp->chkps;
 
 	array_count_t k = array_count(self->buddies);
@@ -199,9 +646,10 @@ array_count_t model_allocator_checkpoint_restore(struct mm_state *self, array_co
 			buddy_ckp = c;
 		}
 	}
+#endif
 
 	for(array_count_t j = array_count(self->logs) - 1; j > i; --j)
-		mm_free(array_get_at(self->logs, j).c);
+		log_free(&array_get_at(self->logs, j));
 
 	array_count(self->logs) = i + 1;
 	return array_get_at(self->logs, i).ref_i;
@@ -228,7 +676,7 @@ array_count_t model_allocator_fossil_lp_collect(struct mm_state *self, array_cou
 	}
 
 	while(j--)
-		mm_free(array_get_at(self->logs, j).c);
+		log_free(&array_get_at(self->logs, j));
 
 	array_truncate_first(self->logs, log_i);
 	return ref_i;
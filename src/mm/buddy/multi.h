@@ -12,13 +12,30 @@
 
 #include <assert.h>
 #include <stdalign.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
+#ifdef ROOTSIM_COW_CHECKPOINTS
+/// The copy of a page of a buddy system, taken right before its first write following a checkpoint
+struct mm_page_copy {
+	/// The buddy system holding the page
+	struct buddy_state *b;
+	/// The index of the page, counted from the start of @a b
+	unsigned page;
+	/// The content of the page at the moment of the checkpoint, NULL if @a b was created after the checkpoint
+	unsigned char *data;
+};
+#endif
+
 /// The checkpoint for the multiple buddy system allocator
 struct mm_checkpoint {
 	/// The total count of allocated bytes at the moment of the checkpoint
 	uint_fast32_t ckpt_size;
+#ifdef ROOTSIM_COW_CHECKPOINTS
+	/// The pages written after the checkpoint, in the order of their first write
+	dyn_array(struct mm_page_copy) pages;
+#endif
 	/// The sequence of checkpoints of the allocated buddy systems (see @a buddy_checkpoint)
 	unsigned char chkps[];
 };
@@ -39,5 +56,15 @@ struct mm_state {
 	dyn_array(struct mm_log) logs;
 	/// The total count of allocated bytes
 	uint_fast32_t full_ckpt_size;
+#ifdef ROOTSIM_INCREMENTAL
+	/// The count of incremental checkpoints in @a logs since the last full one
+	unsigned inc_count;
+	/// If set, the next checkpoint is a full one
+	bool force_full;
+#endif
+#ifdef ROOTSIM_COW_CHECKPOINTS
+	/// The buffers for the next page copies, at least one for each write-protected page not copied yet
+	dyn_array(unsigned char *) spare_pages;
+#endif
 };
 
@@ -0,0 +1,164 @@
+/**
+ * @file mm/ckpt_allocator.c
+ *
+ * @brief Memory management functions for checkpoints
+ *
+ * The checkpoint buffers are rounded up to a set of size classes and, once released, they are cached in thread-local
+ * free lists to serve the next checkpoints of a similar size. Since the checkpoints of an LP have similar sizes from
+ * one to the next, most of the take, restore and fossil collection operations never reach the libc allocator. A buffer
+ * is cached by the thread which releases it, which is not necessarily the one which allocated it, so that no locking
+ * is needed. At each GVT, the free lists are trimmed to the count of buffers handed out since the previous one.
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#include <mm/ckpt_allocator.h>
+
+#include <core/core.h>
+#include <core/intrinsics.h>
+#include <log/stats.h>
+#include <mm/mm.h>
+
+#include <assert.h>
+#include <limits.h>
+
+/// The binary logarithm of the size of the smallest size class
+#define CKPT_CLASS_MIN_EXP 6U
+/// The binary logarithm of the count of size classes between two consecutive powers of two
+#define CKPT_CLASS_SUB_EXP 2U
+/// The count of size classes, enough to serve any size representable with 32 bits
+#define CKPT_CLASS_COUNT (((32U - CKPT_CLASS_MIN_EXP) << CKPT_CLASS_SUB_EXP) + 1U)
+
+/// The header preceding a checkpoint buffer
+union ckpt_buffer {
+	/// The size class of the buffer, while it is in use
+	unsigned size_class;
+	/// The next free buffer of the same size class, while the buffer is cached
+	union ckpt_buffer *next;
+	/// Keeps the buffer following the header suitably aligned for any checkpoint
+	max_align_t align;
+};
+
+/// The thread-local cache of free checkpoint buffers
+static __thread struct {
+	/// The lists of the free buffers, one for each size class
+	union ckpt_buffer *free_lists[CKPT_CLASS_COUNT];
+	/// The count of buffers of each size class handed out since the last GVT
+	unsigned demand[CKPT_CLASS_COUNT];
+	/// The size in bytes of the buffers held in the free lists
+	uint_fast64_t cached;
+} arena;
+
+/**
+ * @brief Compute the size class serving a buffer
+ * @param size the size in bytes of the buffer
+ * @return the smallest size class holding at least @p size bytes
+ *
+ * Each power of two range is split in 1 << CKPT_CLASS_SUB_EXP classes, so that at most a fifth of a buffer is wasted.
+ */
+static inline unsigned size_class_of(size_t size)
+{
+	if(size <= (1U << CKPT_CLASS_MIN_EXP))
+		return 0;
+
+	unsigned w = sizeof(unsigned long long) * CHAR_BIT - intrinsics_clz((unsigned long long)(size - 1));
+	unsigned sub = ((size - 1) >> (w - 1 - CKPT_CLASS_SUB_EXP)) & ((1U << CKPT_CLASS_SUB_EXP) - 1);
+	return ((w - 1 - CKPT_CLASS_MIN_EXP) << CKPT_CLASS_SUB_EXP) + sub + 1;
+}
+
+/**
+ * @brief Compute the size of the buffers of a size class
+ * @param size_class the target size class
+ * @return the size in bytes of the buffers of @p size_class
+ */
+static inline size_t size_class_size(unsigned size_class)
+{
+	if(!size_class)
+		return 1U << CKPT_CLASS_MIN_EXP;
+
+	unsigned w = ((size_class - 1) >> CKPT_CLASS_SUB_EXP) + CKPT_CLASS_MIN_EXP + 1;
+	unsigned sub = (size_class - 1) & ((1U << CKPT_CLASS_SUB_EXP) - 1);
+	return ((size_t)(1U << CKPT_CLASS_SUB_EXP) + sub + 1) << (w - 1 - CKPT_CLASS_SUB_EXP);
+}
+
+/**
+ * @brief Release the cached buffers of a size class
+ * @param size_class the target size class
+ * @param keep the count of buffers to keep cached
+ */
+static void free_list_trim(unsigned size_class, unsigned keep)
+{
+	union ckpt_buffer **p = &arena.free_lists[size_class];
+	while(*p != NULL && keep--)
+		p = &(*p)->next;
+
+	union ckpt_buffer *buf = *p;
+	*p = NULL;
+	while(buf != NULL) {
+		union ckpt_buffer *next = buf->next;
+		mm_free(buf);
+		arena.cached -= size_class_size(size_class);
+		buf = next;
+	}
+}
+
+/**
+ * @brief Finalize the checkpoint allocator thread-local data structures
+ */
+void ckpt_allocator_fini(void)
+{
+	for(unsigned i = 0; i < CKPT_CLASS_COUNT; ++i) {
+		free_list_trim(i, 0);
+		arena.demand[i] = 0;
+	}
+}
+
+/**
+ * @brief Allocate a new checkpoint buffer
+ * @param size the size in bytes of the requested buffer
+ * @return a new buffer with at least the requested amount of space, aligned for any type
+ */
+void *ckpt_allocator_alloc(size_t size)
+{
+	unsigned c = size_class_of(size);
+	assert(c < CKPT_CLASS_COUNT);
+	++arena.demand[c];
+
+	union ckpt_buffer *buf = arena.free_lists[c];
+	if(likely(buf != NULL)) {
+		arena.free_lists[c] = buf->next;
+		arena.cached -= size_class_size(c);
+	} else {
+		buf = mm_alloc(sizeof(*buf) + size_class_size(c));
+	}
+	buf->size_class = c;
+	return buf + 1;
+}
+
+/**
+ * @brief Free a checkpoint buffer
+ * @param ptr a pointer to the buffer to release, as returned by ckpt_allocator_alloc()
+ */
+void ckpt_allocator_free(void *ptr)
+{
+	union ckpt_buffer *buf = (union ckpt_buffer *)ptr - 1;
+	unsigned c = buf->size_class;
+	buf->next = arena.free_lists[c];
+	arena.free_lists[c] = buf;
+	arena.cached += size_class_size(c);
+}
+
+/**
+ * @brief Trim the cached checkpoint buffers after a new GVT has been computed
+ *
+ * The buffers of each size class exceeding the ones handed out since the previous GVT are returned to the libc
+ * allocator, so that the cache follows the recent checkpointing activity of the thread.
+ */
+void ckpt_allocator_on_gvt(void)
+{
+	for(unsigned i = 0; i < CKPT_CLASS_COUNT; ++i) {
+		free_list_trim(i, arena.demand[i]);
+		arena.demand[i] = 0;
+	}
+	stats_take(STATS_CKPT_ARENA, arena.cached);
+}
@@ -0,0 +1,19 @@
+/**
+ * @file mm/ckpt_allocator.h
+ *
+ * @brief Memory management functions for checkpoints
+ *
+ * Memory management functions for checkpoints
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#pragma once
+
+#include <stddef.h>
+
+extern void ckpt_allocator_fini(void);
+
+extern void *ckpt_allocator_alloc(size_t size);
+extern void ckpt_allocator_free(void *ptr);
+extern void ckpt_allocator_on_gvt(void);
@@ -0,0 +1,446 @@
+/**
+ * @file parallel/balance.c
+ *
+ * @brief Load balancing between worker threads
+ *
+ * The load of an LP is the count of its pending messages in the queue of its thread, the work it has ahead. The load of
+ * a thread is the sum of the loads of the LPs it hosts. Counting processed messages instead would tell nothing, since
+ * in an optimistic simulation every thread keeps processing messages, whether they will be committed or not.
+ *
+ * If work stealing is enabled, a thread whose load is well below the highest published one asks the busiest thread
+ * for an LP. The asked thread answers at the end of its current round, when it is not taking part in a GVT
+ * computation. It hands over the LP whose load best evens out the two threads. Its pending messages go along with it.
+ * Ownership is transferred through the LP owners table, see lp_owner_set(). Messages still in flight towards the
+ * former host are forwarded by it when it drains its buffers.
+ *
+ * If periodic rebalancing is enabled, LPs are instead moved only after GVT computations, following their processing
+ * time rather than their pending messages. This reacts slowly, but it is cheap and doesn't need any handshake: every
+ * few GVT computations each thread publishes the processing time of its LPs and, after the next GVT, all the threads
+ * compute the same moves out of the published data. Each thread then hands over its outgoing LPs, and waits for its
+ * incoming ones to show up in the LP owners table.
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#include <parallel/balance.h>
+
+#include <datatypes/msg_queue.h>
+#include <gvt/gvt.h>
+#include <gvt/termination.h>
+#include <log/stats.h>
+
+#include <stdalign.h>
+#include <stdatomic.h>
+
+/// The minimum load difference between two threads which justifies moving an LP from one to the other
+#define BALANCE_STEAL_MIN_LOAD 64U
+/// The minimum load difference between two threads, as a fraction of the highest load, which justifies a steal
+#define BALANCE_STEAL_MIN_RATIO 4U
+
+/**
+ * @brief Checks if the load difference between two threads justifies moving an LP from one to the other
+ * @param busy_load the load of the busier thread
+ * @param idle_load the load of the other thread
+ * @return true if an LP should be moved, false otherwise
+ *
+ * The difference has to be a fair share of the highest load, or threads with similar loads would keep moving LPs back
+ * and forth.
+ */
+#define balance_steal_is_worth(busy_load, idle_load)                                                                   \
+	__extension__({                                                                                                \
+		uint64_t b_ = (busy_load), i_ = (idle_load);                                                           \
+		b_ >= i_ + BALANCE_STEAL_MIN_LOAD && b_ - i_ >= b_ / BALANCE_STEAL_MIN_RATIO;                          \
+	})
+
+/// The minimum processing time difference between two threads, as a fraction of the highest one, justifying a move
+#define BALANCE_REBALANCE_MIN_RATIO 8U
+/// The maximum count of LPs moved in a single rebalancing
+#define BALANCE_REBALANCE_MOVES_MAX 64U
+
+/// The load balancing data of a thread shared with the other threads
+struct balance_thread {
+	/// The load of the thread, as published at the end of its last round
+	alignas(CACHE_LINE_SIZE) _Atomic(uint64_t) load;
+	/// The id of the thread which asked this thread for an LP, BALANCE_RID_NONE if there isn't one
+	_Atomic(rid_t) thief;
+	/// Set by the asked thread if the last steal request of this thread has been granted
+	bool granted;
+	/// The id of the LP handed over to this thread, meaningful only if granted is set
+	lp_id_t stolen;
+	/// Set if the thread had agreed to end the simulation when it last published the processing time of its LPs
+	bool ended;
+};
+
+/// The processing time of an LP, as published by its host thread for the periodic rebalancing
+struct balance_lp {
+	/// The processing time spent on the LP since the previous publication
+	timer_uint work;
+	/// The id of the thread which hosted the LP at the time of the publication
+	rid_t rid;
+};
+
+/// A move of an LP between two threads, planned by the periodic rebalancing
+struct balance_move {
+	/// The id of the LP to move
+	lp_id_t lp_id;
+	/// The id of the thread which hands over the LP
+	rid_t from;
+	/// The id of the thread which takes over the LP
+	rid_t to;
+};
+
+/// The load balancing data of all the threads
+static struct balance_thread *b_threads;
+/// The load of the current thread, that is the count of messages in its queue
+__thread uint64_t balance_load;
+/// The thread asked by the current thread for an LP, BALANCE_RID_NONE if there isn't a pending steal request
+__thread rid_t balance_victim = BALANCE_RID_NONE;
+/// The ids of the LPs hosted by the current thread
+static __thread dyn_array(lp_id_t) lps_owned;
+/// The published processing times of the LPs, for the periodic rebalancing
+static struct balance_lp *b_lps;
+/// The ids of the LPs being moved to the current thread by the periodic rebalancing
+static __thread dyn_array(lp_id_t) lps_incoming;
+/// The count of LPs being moved to the current thread by the periodic rebalancing
+__thread array_count_t balance_incoming;
+/// Set if the current thread published the processing times of its LPs and still has to rebalance them
+__thread bool balance_rebalance_due;
+/// The count of GVT computations completed by the current thread
+static __thread unsigned gvt_count;
+
+/**
+ * @brief Initializes the load balancing subsystem at the node level
+ */
+void balance_global_init(void)
+{
+	b_threads = mm_aligned_alloc(CACHE_LINE_SIZE, global_config.n_threads * sizeof(*b_threads));
+	for(rid_t i = 0; i < global_config.n_threads; ++i) {
+		atomic_store_explicit(&b_threads[i].load, 0, memory_order_relaxed);
+		atomic_store_explicit(&b_threads[i].thief, BALANCE_RID_NONE, memory_order_relaxed);
+		b_threads[i].ended = false;
+	}
+
+	if(global_config.rebalance_period) {
+		b_lps = mm_alloc((lid_node_end - lid_node_first) * sizeof(*b_lps));
+		b_lps -= lid_node_first;
+		// the entries of the LPs hosted by other nodes are left out of any computation
+		for(lp_id_t i = lid_node_first; i < lid_node_end; ++i)
+			b_lps[i].rid = BALANCE_RID_NONE;
+	}
+}
+
+/**
+ * @brief Finalizes the load balancing subsystem at the node level
+ */
+void balance_global_fini(void)
+{
+	mm_aligned_free(b_threads);
+	if(global_config.rebalance_period)
+		mm_free(b_lps + lid_node_first);
+}
+
+/**
+ * @brief Initializes the load balancing subsystem for the current thread
+ *
+ * This must be called after the LPs have been assigned to their initial threads.
+ */
+void balance_init(void)
+{
+	array_init(lps_owned);
+	array_init(lps_incoming);
+	for(lp_id_t i = lid_node_first; i < lid_node_end; ++i)
+		if(lid_to_rid(i) == rid)
+			array_push(lps_owned, i);
+}
+
+/**
+ * @brief Finalizes the load balancing subsystem for the current thread
+ */
+void balance_fini(void)
+{
+	array_fini(lps_owned);
+	array_fini(lps_incoming);
+}
+
+/**
+ * @brief Hands over an LP to a thread which asked for it, if worth it
+ * @param thief the id of the thread which asked for an LP
+ *
+ * The chosen LP is the one which brings the loads of the two threads closest, if the difference is large enough.
+ */
+static void balance_steal_serve(rid_t thief)
+{
+	struct balance_thread *t = &b_threads[thief];
+	uint64_t t_load = atomic_load_explicit(&t->load, memory_order_relaxed);
+	uint64_t diff = balance_load > t_load ? balance_load - t_load : 0;
+	array_count_t best_i = array_count(lps_owned);
+	uint64_t best_diff = diff;
+
+	if(balance_steal_is_worth(balance_load, t_load) && array_count(lps_owned) > 1) {
+		for(array_count_t i = 0; i < array_count(lps_owned); ++i) {
+			uint64_t l = lps[array_get_at(lps_owned, i)].load * 2;
+			uint64_t new_diff = l > diff ? l - diff : diff - l;
+			if(new_diff < best_diff) {
+				best_diff = new_diff;
+				best_i = i;
+			}
+		}
+	}
+
+	t->granted = best_i != array_count(lps_owned);
+	if(!t->granted) {
+		atomic_store_explicit(&b_threads[rid].thief, BALANCE_RID_NONE, memory_order_release);
+		return;
+	}
+
+	lp_id_t lp_id = array_get_at(lps_owned, best_i);
+	array_lazy_remove_at(lps_owned, best_i);
+	termination_lp_leave(&lps[lp_id]);
+	t->stolen = lp_id;
+
+	// the answer must be visible before anyone can see the new owner of the LP
+	atomic_store_explicit(&b_threads[rid].thief, BALANCE_RID_NONE, memory_order_release);
+	array_count_t n = msg_queue_lp_move(lp_id, thief);
+
+	stats_take(STATS_LP_STEAL, 1);
+	stats_take(STATS_LP_STEAL_MSGS, n);
+	stats_take(STATS_LP_STEAL_IMBALANCE, diff - best_diff);
+}
+
+/**
+ * @brief Collects the answer to the pending steal request of the current thread, if it has arrived
+ *
+ * If the request has been granted, the current thread becomes responsible for the stolen LP.
+ */
+static void balance_steal_poll(void)
+{
+	if(atomic_load_explicit(&b_threads[balance_victim].thief, memory_order_acquire) == rid)
+		return;
+
+	balance_victim = BALANCE_RID_NONE;
+	struct balance_thread *me = &b_threads[rid];
+	if(!me->granted)
+		return;
+
+	array_push(lps_owned, me->stolen);
+	termination_lp_join(&lps[me->stolen]);
+}
+
+/**
+ * @brief Takes charge of the LPs moved to the current thread by the periodic rebalancing, if they have arrived
+ */
+static void balance_incoming_poll(void)
+{
+	array_count_t i = array_count(lps_incoming);
+	while(i--) {
+		lp_id_t lp_id = array_get_at(lps_incoming, i);
+		if(lid_to_rid(lp_id) != rid)
+			continue;
+
+		array_lazy_remove_at(lps_incoming, i);
+		array_push(lps_owned, lp_id);
+		termination_lp_join(&lps[lp_id]);
+	}
+	balance_incoming = array_count(lps_incoming);
+}
+
+/**
+ * @brief Takes charge of the LPs handed over to the current thread, if any has arrived
+ *
+ * This must be called before processing a message if balance_lp_pending() is true, since the message may be destined to
+ * a freshly handed over LP.
+ */
+void balance_poll(void)
+{
+	if(balance_steal_pending())
+		balance_steal_poll();
+
+	if(balance_incoming)
+		balance_incoming_poll();
+}
+
+/**
+ * @brief Asks the thread with the highest load for an LP, if worth it
+ */
+static void balance_steal_request(void)
+{
+	rid_t victim = BALANCE_RID_NONE;
+	uint64_t max_load = 0;
+	for(rid_t i = 0; i < global_config.n_threads; ++i) {
+		uint64_t l = atomic_load_explicit(&b_threads[i].load, memory_order_relaxed);
+		if(i != rid && l > max_load) {
+			max_load = l;
+			victim = i;
+		}
+	}
+
+	if(victim == BALANCE_RID_NONE || !balance_steal_is_worth(max_load, balance_load))
+		return;
+
+	rid_t none = BALANCE_RID_NONE;
+	if(atomic_compare_exchange_strong_explicit(&b_threads[victim].thief, &none, rid, memory_order_relaxed,
+	       memory_order_relaxed))
+		balance_victim = victim;
+}
+
+/**
+ * @brief Carries out the load balancing operations due at the end of a processing round of the current thread
+ *
+ * This must be called before msg_queue_flush(), so that the messages of a handed over LP are delivered before the
+ * current thread can take part in a new GVT computation.
+ */
+void balance_on_round(void)
+{
+	if(unlikely(balance_incoming))
+		balance_incoming_poll();
+
+	if(!global_config.work_stealing)
+		return;
+
+	struct balance_thread *me = &b_threads[rid];
+	rid_t thief = atomic_load_explicit(&me->thief, memory_order_relaxed);
+	if(thief != BALANCE_RID_NONE && gvt_is_idle())
+		balance_steal_serve(thief);
+
+	if(balance_steal_pending())
+		balance_steal_poll();
+	else if(!termination_thread_ended())
+		balance_steal_request();
+
+	atomic_store_explicit(&me->load, balance_load, memory_order_relaxed);
+}
+
+/**
+ * @brief Publishes the processing times of the LPs hosted by the current thread, then resets them
+ */
+static void balance_rebalance_publish(void)
+{
+	for(array_count_t i = 0; i < array_count(lps_owned); ++i) {
+		lp_id_t lp_id = array_get_at(lps_owned, i);
+		b_lps[lp_id].work = lps[lp_id].work;
+		b_lps[lp_id].rid = rid;
+		lps[lp_id].work = 0;
+	}
+	b_threads[rid].ended = termination_thread_ended();
+}
+
+/**
+ * @brief Checks if an LP is already moved by a plan
+ * @param moves the planned moves
+ * @param n the count of planned moves
+ * @param lp_id the id of the LP
+ * @return true if @p lp_id is moved in @p moves, false otherwise
+ */
+static bool balance_rebalance_is_moved(const struct balance_move *moves, unsigned n, lp_id_t lp_id)
+{
+	while(n--)
+		if(moves[n].lp_id == lp_id)
+			return true;
+	return false;
+}
+
+/**
+ * @brief Plans the moves of LPs which even out the published processing times of the threads
+ * @param moves the array where to store the planned moves, BALANCE_REBALANCE_MOVES_MAX elements long
+ * @return the count of planned moves
+ *
+ * This greedily moves the LP which best evens out the busiest and the least busy thread, as long as it is worth it.
+ * Threads which agreed to end the simulation are left alone. The plan only depends on the published data, so every
+ * thread comes up with the same one.
+ */
+static unsigned balance_rebalance_plan(struct balance_move *moves)
+{
+	timer_uint loads[global_config.n_threads];
+	for(rid_t i = 0; i < global_config.n_threads; ++i)
+		loads[i] = 0;
+	for(lp_id_t i = lid_node_first; i < lid_node_end; ++i)
+		if(b_lps[i].rid != BALANCE_RID_NONE)
+			loads[b_lps[i].rid] += b_lps[i].work;
+
+	unsigned n = 0;
+	while(n < BALANCE_REBALANCE_MOVES_MAX) {
+		rid_t busy = BALANCE_RID_NONE, idle = BALANCE_RID_NONE;
+		for(rid_t i = 0; i < global_config.n_threads; ++i) {
+			if(b_threads[i].ended)
+				continue;
+			if(busy == BALANCE_RID_NONE || loads[i] > loads[busy])
+				busy = i;
+			if(idle == BALANCE_RID_NONE || loads[i] < loads[idle])
+				idle = i;
+		}
+
+		if(busy == BALANCE_RID_NONE || loads[busy] - loads[idle] < loads[busy] / BALANCE_REBALANCE_MIN_RATIO)
+			break;
+
+		timer_uint diff = loads[busy] - loads[idle], best_diff = diff;
+		lp_id_t best = 0;
+		for(lp_id_t i = lid_node_first; i < lid_node_end; ++i) {
+			if(b_lps[i].rid != busy || balance_rebalance_is_moved(moves, n, i))
+				continue;
+
+			timer_uint w = b_lps[i].work * 2;
+			timer_uint new_diff = w > diff ? w - diff : diff - w;
+			if(new_diff < best_diff) {
+				best_diff = new_diff;
+				best = i;
+			}
+		}
+
+		if(best_diff == diff)
+			break;
+
+		moves[n++] = (struct balance_move){.lp_id = best, .from = busy, .to = idle};
+		loads[busy] -= b_lps[best].work;
+		loads[idle] += b_lps[best].work;
+	}
+	return n;
+}
+
+/**
+ * @brief Moves the LPs between threads as planned out of the published processing times
+ */
+static void balance_rebalance(void)
+{
+	struct balance_move moves[BALANCE_REBALANCE_MOVES_MAX];
+	unsigned n = balance_rebalance_plan(moves);
+
+	for(unsigned i = 0; i < n; ++i) {
+		lp_id_t lp_id = moves[i].lp_id;
+		if(moves[i].to == rid) {
+			array_push(lps_incoming, lp_id);
+			continue;
+		}
+
+		if(moves[i].from != rid)
+			continue;
+
+		array_count_t j = 0;
+		while(array_get_at(lps_owned, j) != lp_id)
+			++j;
+		array_lazy_remove_at(lps_owned, j);
+		termination_lp_leave(&lps[lp_id]);
+		msg_queue_lp_move(lp_id, moves[i].to);
+		stats_take(STATS_LP_REBALANCE, 1);
+	}
+	balance_incoming = array_count(lps_incoming);
+}
+
+/**
+ * @brief Carries out the load balancing operations due after a GVT computation
+ *
+ * This must be called after the termination checks: the current thread must not agree to end the simulation while
+ * balance_lp_incoming() is true.
+ */
+void balance_on_gvt(void)
+{
+	if(!global_config.rebalance_period)
+		return;
+
+	if(balance_rebalance_due) {
+		balance_rebalance_due = false;
+		balance_rebalance();
+	} else if(++gvt_count % global_config.rebalance_period == 0) {
+		balance_rebalance_due = true;
+		balance_rebalance_publish();
+	}
+}
@@ -0,0 +1,77 @@
+/**
+ * @file parallel/balance.h
+ *
+ * @brief Load balancing between worker threads
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#pragma once
+
+#include <core/core.h>
+#include <lp/lp.h>
+
+/// The id used to mean no thread in the load balancing data structures
+#define BALANCE_RID_NONE ((rid_t)-1)
+
+/**
+ * @brief Registers the insertion of a message in the queue of the current thread
+ * @param msg the inserted message, its destination LP must be hosted by the current thread
+ */
+#define balance_on_msg_enqueue(msg)                                                                                    \
+	__extension__({                                                                                                \
+		++lps[(msg)->dest].load;                                                                               \
+		++balance_load;                                                                                        \
+	})
+
+/**
+ * @brief Registers the extraction of a message from the queue of the current thread
+ * @param msg the extracted message
+ */
+#define balance_on_msg_dequeue(msg)                                                                                    \
+	__extension__({                                                                                                \
+		--lps[(msg)->dest].load;                                                                               \
+		--balance_load;                                                                                        \
+	})
+
+/**
+ * @brief Registers the processing of a message in the load balancing subsystem
+ * @param lp the LP which processed the message
+ * @param t the time spent processing the message
+ */
+#define balance_on_msg_process(lp, t) ((lp)->work += (t))
+
+/**
+ * @brief Checks if the current thread is waiting for the answer to a steal request
+ * @return true if a steal request of the current thread is pending, false otherwise
+ */
+#define balance_steal_pending() (balance_victim != BALANCE_RID_NONE)
+
+/**
+ * @brief Checks if an LP may be handed over to the current thread at any moment
+ * @return true if an LP may be handed over to the current thread, false otherwise
+ *
+ * If this is true, balance_poll() has to be called before processing any message.
+ */
+#define balance_lp_pending() (balance_steal_pending() || balance_incoming)
+
+/**
+ * @brief Checks if LPs may be handed over to the current thread before the next GVT computation completes
+ * @return true if LPs may be handed over to the current thread, false otherwise
+ *
+ * If this is true, the current thread must not agree to end the simulation.
+ */
+#define balance_lp_incoming() (balance_lp_pending() || balance_rebalance_due)
+
+extern __thread uint64_t balance_load;
+extern __thread rid_t balance_victim;
+extern __thread array_count_t balance_incoming;
+extern __thread bool balance_rebalance_due;
+
+extern void balance_global_init(void);
+extern void balance_global_fini(void);
+extern void balance_init(void);
+extern void balance_fini(void);
+extern void balance_on_round(void);
+extern void balance_on_gvt(void);
+extern void balance_poll(void);
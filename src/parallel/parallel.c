@@ -14,8 +14,11 @@
 #include <datatypes/msg_queue.h>
 #include <distributed/mpi.h>
 #include <gvt/fossil.h>
+#include <gvt/throttle.h>
 #include <log/stats.h>
+#include <mm/ckpt_allocator.h>
 #include <mm/msg_allocator.h>
+#include <parallel/balance.h>
 
 /**
  * @brief Set the affinity of the current worker thread to the core it is supposed to run on
@@ -54,10 +57,13 @@ static void worker_thread_init(rid_t this_rid)
 	worker_affinity_set();
 	stats_init();
 	auto_ckpt_init();
+	throttle_init();
 	msg_allocator_init();
 	msg_queue_init();
 	sync_thread_barrier();
 	lp_init();
+	balance_init();
+	msg_queue_flush();
 
 	if(sync_thread_barrier()) {
 		mpi_node_barrier();
@@ -86,6 +92,8 @@ static void worker_thread_fini(void)
 	}
 
 	lp_fini();
+	ckpt_allocator_fini();
+	balance_fini();
 	msg_queue_fini();
 	sync_thread_barrier();
 	msg_allocator_fini();
@@ -110,12 +118,20 @@ static thrd_ret_t THREAD_CALL_CONV parallel_thread_run(void *rid_arg)
 		while(i--)
 			process_msg();
 
+		balance_on_round();
+		msg_queue_flush();
+
 		simtime_t current_gvt = gvt_phase_run();
 		if(unlikely(current_gvt != 0.0)) {
-			termination_on_gvt(current_gvt);
+			// LPs may be handed over to this thread in the meanwhile
+			if(likely(!balance_lp_incoming()))
+				termination_on_gvt(current_gvt);
 			auto_ckpt_on_gvt();
 			fossil_on_gvt(current_gvt);
+			ckpt_allocator_on_gvt();
+			balance_on_gvt();
 			msg_allocator_on_gvt(current_gvt);
+			throttle_on_gvt(current_gvt);
 			stats_on_gvt(current_gvt);
 		}
 	}
@@ -132,6 +148,7 @@ static void parallel_global_init(void)
 {
 	stats_global_init();
 	lp_global_init();
+	balance_global_init();
 	msg_queue_global_init();
 	termination_global_init();
 	gvt_global_init();
@@ -143,6 +160,7 @@ static void parallel_global_init(void)
 static void parallel_global_fini(void)
 {
 	msg_queue_global_fini();
+	balance_global_fini();
 	lp_global_fini();
 	stats_global_fini();
 }
@@ -14,8 +14,8 @@
 #include <lp/common.h>
 #include <mm/msg_allocator.h>
 
-/// The messages queue of the serial runtime
-static heap_declare(struct lp_msg *) queue;
+/// The messages queue of the serial runtime, messages with the same timestamp are ordered by msg_is_before_extended()
+static dheap_declare(struct lp_msg *) queue;
 
 /**
  * @brief Initialize the serial simulation environment
@@ -25,7 +25,7 @@ static void serial_simulation_init(void)
 	stats_global_init();
 	stats_init();
 	msg_allocator_init();
-	heap_init(queue);
+	dheap_init(queue);
 
 	lps = mm_alloc(sizeof(*lps) * global_config.lps);
 	memset(lps, 0, sizeof(*lps) * global_config.lps);
@@ -44,11 +44,11 @@ static void serial_simulation_init(void)
 		lp->state_pointer = NULL;
 
 		struct lp_msg *msg = msg_allocator_pack(i, 0.0, LP_INIT, NULL, 0);
-		heap_insert(queue, msg_is_before, msg);
+		dheap_insert(queue, msg_is_before_extended, heap_pos_ignore, msg->dest_t, msg);
 
 		common_msg_process(lp, msg);
 
-		msg_allocator_free(heap_extract(queue, msg_is_before));
+		msg_allocator_free(dheap_extract(queue, msg_is_before_extended, heap_pos_ignore));
 	}
 	lp_initialized_set();
 }
@@ -65,12 +65,12 @@ static void serial_simulation_fini(void)
 		model_allocator_lp_fini(&lp->mm_state);
 	}
 
-	for(array_count_t i = 0; i < array_count(queue); ++i)
-		msg_allocator_free(array_get_at(queue, i));
+	for(array_count_t i = 0; i < dheap_count(queue); ++i)
+		msg_allocator_free(dheap_items(queue)[i]);
 
 	mm_free(lps);
 
-	heap_fini(queue);
+	dheap_fini(queue);
 	msg_allocator_fini();
 	stats_global_fini();
 }
@@ -83,8 +83,8 @@ static int serial_simulation_run(void)
 	timer_uint last_vt = timer_new();
 	lp_id_t to_terminate = global_config.lps;
 
-	while(likely(!heap_is_empty(queue))) {
-		const struct lp_msg *msg = heap_min(queue);
+	while(likely(!dheap_is_empty(queue))) {
+		const struct lp_msg *msg = dheap_min(queue);
 		struct lp_ctx *lp = &lps[msg->dest];
 		current_lp = lp;
 
@@ -106,7 +106,7 @@ static int serial_simulation_run(void)
 		}
 
 		timer_uint t = timer_hr_new();
-		struct lp_msg *to_free = heap_extract(queue, msg_is_before);
+		struct lp_msg *to_free = dheap_extract(queue, msg_is_before_extended, heap_pos_ignore);
 		stats_take(STATS_MSG_EXTRACTION, timer_hr_value(t));
 		msg_allocator_free(to_free);
 	}
@@ -130,13 +130,13 @@ void ScheduleNewEvent_serial(lp_id_t receiver, simtime_t timestamp, unsigned eve
 	struct lp_msg *msg = msg_allocator_pack(receiver, timestamp, event_type, payload, payload_size);
 
 #ifndef NDEBUG
-	if(unlikely(msg_is_before(msg, heap_min(queue)))) {
+	if(unlikely(msg_is_before(msg, dheap_min(queue)))) {
 		logger(LOG_FATAL, "Sending a message in the PAST!");
 		abort();
 	}
 #endif
 
-	heap_insert(queue, msg_is_before, msg);
+	dheap_insert(queue, msg_is_before_extended, heap_pos_ignore, timestamp, msg);
 }
 
 /**
@@ -0,0 +1,88 @@
+/**
+ * @file test/datatypes/bitlog.c
+ *
+ * @brief Test: bit log datatype
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#include <datatypes/bitlog.h>
+
+#include <test.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BITLOG_FIELDS 4096
+#define BITLOG_OPS 1000000
+
+static int bitlog_test(_unused void *_)
+{
+	struct bitlog bl;
+	bitlog_init(&bl);
+
+	// a shadow copy of the bit fields in the log, with their widths and the log end before each of them
+	uint64_t *vals = malloc(BITLOG_FIELDS * sizeof(*vals));
+	uint64_t *ends = malloc(BITLOG_FIELDS * sizeof(*ends));
+	unsigned *widths = malloc(BITLOG_FIELDS * sizeof(*widths));
+	unsigned first = 0, count = 0;
+
+	for(unsigned n = 0; n < BITLOG_OPS; ++n) {
+		switch(test_random_range(count == BITLOG_FIELDS ? 2 : 5)) {
+			case 0:
+				// discard some of the oldest fields, as if they were committed
+				if(count > first) {
+					first += test_random_range(count - first + 1);
+					bitlog_discard(&bl, first < count ? ends[first] : bitlog_end(&bl));
+				}
+				break;
+			case 1:
+				if(count == first)
+					break;
+				--count;
+				if(bitlog_pop(&bl, widths[count]) != vals[count] || bitlog_end(&bl) != ends[count])
+					return -1;
+				break;
+			default:
+				widths[count] = test_random_range(64) + 1;
+				vals[count] = test_random_u();
+				if(widths[count] < 64)
+					vals[count] &= (UINT64_C(1) << widths[count]) - 1;
+				ends[count] = bitlog_end(&bl);
+				// the bits exceeding the width must be ignored
+				bitlog_push(&bl, vals[count] | (~UINT64_C(0) << (widths[count] % 64)) * (widths[count] < 64),
+				    widths[count]);
+				++count;
+		}
+
+		if(count == BITLOG_FIELDS && first) {
+			// make room by forgetting about the discarded fields
+			memmove(vals, vals + first, (count - first) * sizeof(*vals));
+			memmove(ends, ends + first, (count - first) * sizeof(*ends));
+			memmove(widths, widths + first, (count - first) * sizeof(*widths));
+			count -= first;
+			first = 0;
+		}
+
+		// the fields not discarded must still be held in the log
+		if(count > first && bitlog_size(&bl) < bitlog_end(&bl) - ends[first])
+			return -1;
+	}
+
+	while(count > first) {
+		--count;
+		if(bitlog_pop(&bl, widths[count]) != vals[count])
+			return -1;
+	}
+
+	bitlog_fini(&bl);
+	free(widths);
+	free(ends);
+	free(vals);
+	return 0;
+}
+
+int main(void)
+{
+	test("Testing bit log implementation", bitlog_test, NULL);
+}
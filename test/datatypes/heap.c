@@ -0,0 +1,169 @@
+/**
+ * @file test/datatypes/heap.c
+ *
+ * @brief Test: binary and d-ary heap datatypes
+ *
+ * Besides checking the correctness of both heaps, this compares their performance in the classic hold model: the heap
+ * is filled with n elements and then n extractions are performed, each followed by the insertion of an element with a
+ * slightly larger key. Define HEAP_BENCH_MAX to 10000000 to also run the largest size.
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#include <arch/timer.h>
+#include <datatypes/heap.h>
+
+#include <test.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HEAP_OPS 200000
+#define HEAP_KEYS 1000
+
+#ifndef HEAP_BENCH_MAX
+#define HEAP_BENCH_MAX 1000000
+#endif
+
+/// An element as the ones in the message queue
+struct h_elem {
+	simtime_t t;
+	unsigned id;
+};
+
+#define h_elem_is_before(a, b) ((a).t < (b).t || ((a).t == (b).t && (a).id < (b).id))
+#define h_id_is_before(a, b) ((a) < (b))
+
+static array_count_t *positions;
+
+#define h_id_pos_set(id, i) (positions[id] = (i))
+
+static int binary_heap_test(_unused void *_)
+{
+	heap_declare(struct h_elem) h;
+	heap_init(h);
+	struct h_elem *batch = malloc(sizeof(*batch) * HEAP_OPS);
+	unsigned id = 0;
+
+	for(unsigned r = 0; r < 16; ++r) {
+		unsigned n = test_random_range(HEAP_OPS / 16);
+		for(unsigned i = 0; i < n; ++i) {
+			batch[i].t = test_random_range(HEAP_KEYS);
+			batch[i].id = id++;
+		}
+		heap_insert_n(h, h_elem_is_before, batch, n);
+
+		n = test_random_range(heap_count(h) + 1);
+		struct h_elem last = {.t = -1.0};
+		while(n--) {
+			struct h_elem e = heap_extract(h, h_elem_is_before);
+			if(h_elem_is_before(e, last))
+				return -1;
+			last = e;
+		}
+	}
+
+	heap_fini(h);
+	free(batch);
+	return 0;
+}
+
+static int dary_heap_test(_unused void *_)
+{
+	dheap_declare(unsigned) h;
+	dheap_init(h);
+	positions = malloc(sizeof(*positions) * HEAP_OPS);
+	simtime_t *keys = malloc(sizeof(*keys) * HEAP_OPS);
+	unsigned id = 0;
+
+	while(id < HEAP_OPS) {
+		// either a bulk insertion, a burst of single insertions or a burst of removals of random elements
+		unsigned n = test_random_range(HEAP_OPS / 64);
+		switch(test_random_range(3)) {
+			case 0:
+				n = n < HEAP_OPS - id ? n : HEAP_OPS - id;
+				for(unsigned i = 0; i < n; ++i, ++id) {
+					keys[id] = test_random_range(HEAP_KEYS);
+					dheap_push(h, keys[id], id);
+				}
+				dheap_heapify_tail(h, h_id_is_before, h_id_pos_set, n);
+				break;
+			case 1:
+				for(unsigned i = 0; i < n && id < HEAP_OPS; ++i, ++id) {
+					keys[id] = test_random_range(HEAP_KEYS);
+					dheap_insert(h, h_id_is_before, h_id_pos_set, keys[id], id);
+				}
+				break;
+			default:
+				for(unsigned i = 0; i < n && !dheap_is_empty(h); ++i) {
+					unsigned r = dheap_items(h)[test_random_range(dheap_count(h))];
+					if(dheap_remove_at(h, h_id_is_before, h_id_pos_set, positions[r]) != r)
+						return -1;
+				}
+		}
+
+		for(array_count_t i = 0; i < dheap_count(h); ++i)
+			if(positions[dheap_items(h)[i]] != i || dheap_keys(h)[i] != keys[dheap_items(h)[i]])
+				return -1;
+	}
+
+	simtime_t last_t = -1.0;
+	unsigned last_id = 0;
+	while(!dheap_is_empty(h)) {
+		simtime_t t = dheap_min_key(h);
+		unsigned e = dheap_extract(h, h_id_is_before, h_id_pos_set);
+		if(t < last_t || (t == last_t && e < last_id) || keys[e] != t)
+			return -1;
+		last_t = t;
+		last_id = e;
+	}
+
+	dheap_fini(h);
+	free(keys);
+	free(positions);
+	return 0;
+}
+
+static int heap_benchmark(_unused void *_)
+{
+	for(unsigned n = 10000; n <= HEAP_BENCH_MAX; n *= 10) {
+		heap_declare(struct h_elem) b;
+		heap_init(b);
+		for(unsigned i = 0; i < n; ++i) {
+			struct h_elem e = {.t = test_random_double() * n, .id = i};
+			heap_insert(b, h_elem_is_before, e);
+		}
+		timer_uint t = timer_new();
+		for(unsigned i = 0; i < n; ++i) {
+			struct h_elem e = heap_extract(b, h_elem_is_before);
+			e.t += test_random_double() * 10.0;
+			heap_insert(b, h_elem_is_before, e);
+		}
+		timer_uint binary_us = timer_value(t);
+		heap_fini(b);
+
+		dheap_declare(unsigned) d;
+		dheap_init(d);
+		for(unsigned i = 0; i < n; ++i)
+			dheap_insert(d, dheap_no_tie, heap_pos_ignore, test_random_double() * n, i);
+		t = timer_new();
+		for(unsigned i = 0; i < n; ++i) {
+			simtime_t k = dheap_min_key(d) + test_random_double() * 10.0;
+			unsigned e = dheap_extract(d, dheap_no_tie, heap_pos_ignore);
+			dheap_insert(d, dheap_no_tie, heap_pos_ignore, k, e);
+		}
+		timer_uint dary_us = timer_value(t);
+		dheap_fini(d);
+
+		printf("%u elements: binary heap %llu us, %u-ary heap %llu us\n", n, (unsigned long long)binary_us,
+		    DHEAP_ARITY, (unsigned long long)dary_us);
+	}
+	return 0;
+}
+
+int main(void)
+{
+	test("Testing binary heap implementation", binary_heap_test, NULL);
+	test("Testing d-ary heap implementation", dary_heap_test, NULL);
+	test("Benchmarking binary and d-ary heaps", heap_benchmark, NULL);
+}
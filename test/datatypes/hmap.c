@@ -0,0 +1,85 @@
+/**
+ * @file test/datatypes/hmap.c
+ *
+ * @brief Test: hash map datatype
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#include <datatypes/hmap.h>
+
+#include <test.h>
+
+#include <stdlib.h>
+
+#define HMAP_KEYS 4096
+#define HMAP_OPS 1000000
+
+static int hmap_test(_unused void *_)
+{
+	struct hmap h;
+	hmap_init(&h);
+
+	// a shadow copy of the hash map content, keys are clustered to stress the probing
+	uint64_t *vals = calloc(HMAP_KEYS, sizeof(*vals));
+	unsigned count = 0;
+
+	for(unsigned n = 0; n < HMAP_OPS; ++n) {
+		unsigned k = test_random_range(HMAP_KEYS);
+		uint64_t key = ((uint64_t)k << 3) + 8, val;
+		bool found = hmap_lookup(&h, key, &val);
+		if(found != (vals[k] != 0) || (found && val != vals[k]))
+			return -1;
+
+		switch(test_random_range(3)) {
+			case 0:
+				if(hmap_remove(&h, key) != found)
+					return -1;
+				count -= found;
+				vals[k] = 0;
+				break;
+			default:
+				count += !found;
+				vals[k] = test_random_u() | 1U;
+				hmap_insert(&h, key, vals[k]);
+		}
+
+		if(hmap_count(&h) != count)
+			return -1;
+	}
+
+	for(unsigned k = 0; k < HMAP_KEYS; ++k) {
+		uint64_t val;
+		if(hmap_lookup(&h, ((uint64_t)k << 3) + 8, &val) != (vals[k] != 0))
+			return -1;
+	}
+
+	// remove about half of the entries while scanning the slots
+	for(array_count_t i = 0; i < hmap_capacity(&h);) {
+		if(!hmap_slot_at(&h, i).key || !(hmap_slot_at(&h, i).val & 2U)) {
+			++i;
+			continue;
+		}
+		vals[(hmap_slot_at(&h, i).key - 8) >> 3] = 0;
+		hmap_remove_at(&h, i);
+		--count;
+	}
+
+	for(unsigned k = 0; k < HMAP_KEYS; ++k) {
+		uint64_t val;
+		if(hmap_lookup(&h, ((uint64_t)k << 3) + 8, &val) != (vals[k] != 0) || (vals[k] && val != vals[k]))
+			return -1;
+	}
+
+	if(hmap_count(&h) != count)
+		return -1;
+
+	hmap_fini(&h);
+	free(vals);
+	return 0;
+}
+
+int main(void)
+{
+	test("Testing hash map implementation", hmap_test, NULL);
+}
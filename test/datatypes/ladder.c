@@ -0,0 +1,138 @@
+/**
+ * @file test/datatypes/ladder.c
+ *
+ * @brief Test: ladder queue datatype
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#include <datatypes/ladder.h>
+
+#include <test.h>
+
+#include <stdlib.h>
+
+#define LADDER_MSGS 200000
+#define LADDER_ROUNDS 8
+#define LADDER_LPS 64
+
+static int ladder_test(_unused void *_)
+{
+	struct ladder l;
+	ladder_init(&l);
+
+	struct lp_msg *msgs = malloc(sizeof(*msgs) * LADDER_MSGS);
+	unsigned inserted = 0, extracted = 0;
+	simtime_t last = 0.0;
+
+	for(unsigned r = 0; r < LADDER_ROUNDS; ++r) {
+		// insert a burst of messages, not preceding the ones already extracted
+		unsigned n = LADDER_MSGS / LADDER_ROUNDS / 2;
+		while(n-- && inserted < LADDER_MSGS) {
+			struct lp_msg *msg = &msgs[inserted++];
+			msg->dest_t = last + test_random_double() * 100.0;
+			if(test_random_range(4) == 0) // a burst of equal timestamps
+				msg->dest_t = last + 1.0;
+			ladder_insert(&l, msg);
+		}
+
+		// extract part of them, interleaving new insertions in the near future
+		n = LADDER_MSGS / LADDER_ROUNDS / 4;
+		while(n--) {
+			struct lp_msg *msg = ladder_extract(&l);
+			if(msg == NULL || msg->dest_t < last)
+				return -1;
+			last = msg->dest_t;
+			++extracted;
+
+			if(test_random_range(8) == 0 && inserted < LADDER_MSGS) {
+				msg = &msgs[inserted++];
+				msg->dest_t = last + test_random_double();
+				ladder_insert(&l, msg);
+			}
+		}
+	}
+
+	struct lp_msg *msg;
+	while((msg = ladder_extract(&l)) != NULL) {
+		if(msg->dest_t < last)
+			return -1;
+		last = msg->dest_t;
+		++extracted;
+	}
+
+	ladder_fini(&l);
+	free(msgs);
+	return -(extracted != inserted);
+}
+
+static int ladder_evict_test(_unused void *_)
+{
+	struct ladder l;
+	ladder_init(&l);
+
+	struct lp_msg *msgs = malloc(sizeof(*msgs) * LADDER_MSGS);
+	unsigned pending[LADDER_LPS] = {0};
+	unsigned inserted = 0;
+	simtime_t last = 0.0;
+
+	while(inserted < LADDER_MSGS) {
+		// keep the queue crowded, so that the messages are spread over the top list, the rungs and the bottom
+		for(unsigned n = test_random_range(LADDER_MSGS / 32); n-- && inserted < LADDER_MSGS;) {
+			struct lp_msg *msg = &msgs[inserted++];
+			msg->dest_t = last + test_random_double() * 100.0;
+			msg->dest = test_random_range(LADDER_LPS);
+			++pending[msg->dest];
+			ladder_insert(&l, msg);
+		}
+
+		for(unsigned n = test_random_range(LADDER_MSGS / 64); n--;) {
+			struct lp_msg *msg = ladder_extract(&l);
+			if(msg == NULL)
+				break;
+			if(msg->dest_t < last)
+				return -1;
+			last = msg->dest_t;
+			--pending[msg->dest];
+		}
+
+		// evict the messages of an LP, then insert back some of them
+		lp_id_t lp = test_random_range(LADDER_LPS);
+		unsigned expected = pending[lp], evicted = 0;
+		struct lp_msg *msg = ladder_evict(&l, lp);
+		while(msg != NULL) {
+			struct lp_msg *next = msg->next;
+			if(msg->dest != lp || msg->dest_t < last)
+				return -1;
+			++evicted;
+			if(test_random_range(2))
+				ladder_insert(&l, msg);
+			else
+				--pending[lp];
+			msg = next;
+		}
+		if(evicted != expected || ladder_evict(&l, LADDER_LPS) != NULL)
+			return -1;
+	}
+
+	struct lp_msg *msg;
+	while((msg = ladder_extract(&l)) != NULL) {
+		if(msg->dest_t < last || !pending[msg->dest]--)
+			return -1;
+		last = msg->dest_t;
+	}
+
+	for(unsigned i = 0; i < LADDER_LPS; ++i)
+		if(pending[i])
+			return -1;
+
+	ladder_fini(&l);
+	free(msgs);
+	return 0;
+}
+
+int main(void)
+{
+	test("Testing ladder queue implementation", ladder_test, NULL);
+	test("Testing ladder queue eviction", ladder_evict_test, NULL);
+}
@@ -35,11 +35,15 @@ void ProcessEvent(lp_id_t me, simtime_t now, unsigned event_type, const void *ev
 		puts("[ERROR] Requested to process a weird event!");
 		abort();
 	}
+	if(state)
+		write_report(state, sizeof(*state));
+
 	switch(event_type) {
 		case LP_INIT:
 			state = rs_malloc(sizeof(lp_state));
 			if(state == NULL)
 				exit(-1);
+			write_report(state, sizeof(*state));
 
 			memset(state, 0, sizeof(lp_state));
 
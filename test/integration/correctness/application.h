@@ -22,6 +22,13 @@
 #define NULLING_PROBABILITY 0.3
 #define COMPLETE_EVENTS 15000
 
+#if defined(ROOTSIM_INCREMENTAL) && !defined(WRITES_INSTRUMENTED)
+// without the LLVM pass, the model itself reports its writes to the LP memory for the incremental checkpoints
+#define write_report(ptr, size) __write_mem(ptr, size)
+#else
+#define write_report(ptr, size) ((void)0)
+#endif
+
 enum { LOOP, RECEIVE };
 
 typedef struct lp_buffer {
@@ -29,6 +29,7 @@ uint32_t read_buffer(buffer *head, unsigned i, uint32_t old_crc)
 buffer *allocate_buffer(lp_state *state, const unsigned *data, unsigned count)
 {
 	buffer *new = rs_malloc(sizeof(buffer) + count * sizeof(uint64_t));
+	write_report(new, sizeof(buffer) + count * sizeof(uint64_t));
 	new->next = state->head;
 	new->count = count;
 
@@ -52,6 +53,7 @@ buffer *deallocate_buffer(buffer *head, unsigned i)
 	}
 
 	if(prev != NULL) {
+		write_report(&prev->next, sizeof(prev->next));
 		prev->next = to_free->next;
 		rs_free(to_free);
 		return head;
@@ -10,6 +10,28 @@
 
 #include "application.h"
 
+#ifndef WORK_STEALING
+#define WORK_STEALING false
+#endif
+
+#ifndef REBALANCE_PERIOD
+#define REBALANCE_PERIOD 0
+#endif
+
+#ifndef LAZY_CANCELLATION
+#define LAZY_CANCELLATION false
+#endif
+
+#ifdef PLACEMENT_INTERLEAVED
+static unsigned placement_interleaved(lp_id_t lp_id, unsigned n_workers)
+{
+	return lp_id % n_workers;
+}
+#define PLACEMENT placement_interleaved
+#else
+#define PLACEMENT NULL
+#endif
+
 struct simulation_configuration conf = {
     .lps = N_LPS,
     .n_threads = 2,
@@ -19,9 +41,13 @@ struct simulation_configuration conf = {
     .stats_file = NULL,
     .ckpt_interval = 0,
     .core_binding = false,
+    .work_stealing = WORK_STEALING,
+    .rebalance_period = REBALANCE_PERIOD,
+    .lazy_cancellation = LAZY_CANCELLATION,
     .serial = false,
     .dispatcher = ProcessEvent,
     .committed = CanEnd,
+    .placement = PLACEMENT,
 };
 
 static int correctness(void *config)
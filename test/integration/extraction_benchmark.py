@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+# SPDX-License-Identifier: GPL-3.0-only
+
+"""
+This script reports side by side the message extraction cost of the pending events sets, as measured in the
+statistics files of the same simulation run against a core library with each of them.
+
+The script requires the path to the rootsim_stats.py script, followed by one or more arguments in the form
+<pending events set>=<statistics file>. It fails if a statistics file is missing or if a run processed no message.
+"""
+import runpy
+import sys
+
+
+def extraction_cost_get(rs_stats, stats_path):
+    """
+    Get the message extraction cost of a simulation run
+
+    :param rs_stats: the RSStats class of the rootsim_stats.py script
+    :param stats_path: the path of the statistics file of the run
+    :return: the count of processed messages and the total time spent extracting messages
+    """
+    stats = rs_stats(stats_path)
+    msgs = stats.thread_metric_get("processed messages", aggregate_gvts=True, aggregate_nodes=True)
+    extraction = stats.thread_metric_get("messages extraction time", aggregate_gvts=True, aggregate_nodes=True)
+    return msgs, extraction
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        print("Need the rootsim_stats.py path and at least a <pending events set>=<statistics file> pair!",
+              file=sys.stderr)
+        sys.exit(1)
+
+    RS_STATS = runpy.run_path(sys.argv[1])["RSStats"]
+    for arg in sys.argv[2:]:
+        queue, path = arg.split("=", 1)
+        processed, extraction_time = extraction_cost_get(RS_STATS, path)
+        if not processed:
+            sys.exit(1)
+        # the extraction time is measured with the high resolution timer, in CPU dependent units (TSC ticks on x86)
+        print(f"{queue}: {processed} processed messages, {extraction_time} extraction time units, "
+              f"{extraction_time / processed:.1f} per processed message")
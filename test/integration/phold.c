@@ -14,6 +14,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifndef NUM_LPS
 #define NUM_LPS 8192
@@ -23,10 +24,62 @@
 #define NUM_THREADS 0
 #endif
 
+#ifndef START_EVENTS
+#define START_EVENTS 1
+#endif
+
+#ifndef TERMINATION_TIME
+#define TERMINATION_TIME 1000
+#endif
+
+#ifndef HOT_LPS
+#define HOT_LPS 0
+#endif
+
+#ifndef WORK_STEALING
+#define WORK_STEALING false
+#endif
+
+#ifndef REBALANCE_PERIOD
+#define REBALANCE_PERIOD 0
+#endif
+
+#ifndef LOCALITY
+#define LOCALITY 0.0
+#endif
+
+#ifndef OPTIMISM_THROTTLING
+#define OPTIMISM_THROTTLING false
+#endif
+
+#ifndef LOOKAHEAD
+#define LOOKAHEAD 0.0
+#endif
+
+#ifndef HYBRID
+#define HYBRID false
+#endif
+
+#ifndef REVERSE
+#define REVERSE false
+#endif
+
+#ifndef STATS_FILE
+#define STATS_FILE "phold"
+#endif
+
 #define EVENT 1
 
+#ifdef ROOTSIM_INCREMENTAL
+// without the LLVM pass, the model itself reports its writes to the LP memory for the incremental checkpoints
+#define write_report(ptr, size) __write_mem(ptr, size)
+#else
+#define write_report(ptr, size) ((void)0)
+#endif
+
 struct phold_state {
 	__uint128_t seed;
+	simtime_t last_t;
 };
 
 struct phold_message {
@@ -35,12 +88,17 @@ struct phold_message {
 
 static simtime_t p_remote = 0.25;
 static simtime_t mean = 1.0;
-static simtime_t lookahead = 0.0;
-static int start_events = 1;
+static simtime_t lookahead = LOOKAHEAD;
+static int start_events = START_EVENTS;
+static lp_id_t hot_lps = HOT_LPS;
+static double locality = LOCALITY;
+
+static const __uint128_t multiplier = (((__uint128_t)0x0fc94e3bf4e9ab32ULL) << 64) + 0x866458cd56f5e605ULL;
+/// The inverse of the multiplier modulo 2^128, used to step back the random number generator
+static __uint128_t multiplier_inv;
 
 static double Random(struct phold_state *state)
 {
-	const __uint128_t multiplier = (((__uint128_t)0x0fc94e3bf4e9ab32ULL) << 64) + 0x866458cd56f5e605ULL;
 	state->seed *= multiplier;
 	uint64_t ret = state->seed >> 64u;
 	return (double)ret / (double)UINT64_MAX;
@@ -68,10 +126,13 @@ void ProcessEvent(lp_id_t me, simtime_t now, unsigned event_type, _unused const
 			state = rs_malloc(sizeof(*state));
 			if(state == NULL)
 				abort();
+			write_report(state, sizeof(*state));
 			set_seed(me, state);
+			state->last_t = 0.0;
 			SetState(state);
 
-			for(int i = 0; i < start_events; i++)
+			// the first hot_lps LPs start with much more events than the others, loading their threads
+			for(int i = 0; i < (me < hot_lps ? start_events * 64 : start_events); i++)
 				ScheduleNewEvent(me, Expent(state) + lookahead, EVENT, &new_event, sizeof(new_event));
 			break;
 
@@ -79,11 +140,33 @@ void ProcessEvent(lp_id_t me, simtime_t now, unsigned event_type, _unused const
 			break;
 
 		case EVENT:
+			write_report(state, sizeof(*state));
+			// the events of an LP must be processed, and undone, in order
+			if(now < state->last_t) {
+				fprintf(stderr, "Out of order event\n");
+				abort();
+			}
+			uint64_t last_t_bits;
+			memcpy(&last_t_bits, &state->last_t, sizeof(last_t_bits));
+			rs_bitlog_push(last_t_bits, 64);
+			state->last_t = now;
+
+			// with locality, LPs schedule for themselves bursts of events in the immediate future
+			if(Random(state) < locality) {
+				ScheduleNewEvent(me, now + Expent(state) / 65536 + lookahead, EVENT, &new_event,
+				    sizeof(new_event));
+				rs_bitlog_push(0, 2);
+				break;
+			}
+
 			dest = me;
-			if(Random(state) <= p_remote)
+			bool remote = Random(state) <= p_remote;
+			if(remote)
 				dest = (lp_id_t)(Random(state) * NUM_LPS);
 
 			ScheduleNewEvent(dest, now + Expent(state) + lookahead, EVENT, &new_event, sizeof(new_event));
+			// the count of random numbers drawn, besides the first two, is the only information lost
+			rs_bitlog_push(1 + remote, 2);
 			break;
 
 		default:
@@ -92,6 +175,22 @@ void ProcessEvent(lp_id_t me, simtime_t now, unsigned event_type, _unused const
 	}
 }
 
+void ReverseEvent(_unused lp_id_t me, simtime_t now, unsigned event_type, _unused const void *content,
+    _unused unsigned size, void *s)
+{
+	struct phold_state *state = (struct phold_state *)s;
+	if(event_type != EVENT || now != state->last_t) {
+		fprintf(stderr, "Out of order reverse event\n");
+		abort();
+	}
+
+	for(uint64_t draws = rs_bitlog_pop(2) + 2; draws; --draws)
+		state->seed *= multiplier_inv;
+
+	uint64_t last_t_bits = rs_bitlog_pop(64);
+	memcpy(&state->last_t, &last_t_bits, sizeof(state->last_t));
+}
+
 bool CanEnd(_unused lp_id_t me, _unused const void *snapshot)
 {
 	return false;
@@ -100,19 +199,30 @@ bool CanEnd(_unused lp_id_t me, _unused const void *snapshot)
 struct simulation_configuration conf = {
     .lps = NUM_LPS,
     .n_threads = NUM_THREADS,
-    .termination_time = 1000,
+    .termination_time = TERMINATION_TIME,
     .gvt_period = 1000,
     .log_level = LOG_INFO,
-    .stats_file = "phold",
+    .stats_file = STATS_FILE,
     .ckpt_interval = 0,
     .core_binding = true,
+    .work_stealing = WORK_STEALING,
+    .rebalance_period = REBALANCE_PERIOD,
+    .lookahead = LOOKAHEAD,
+    .hybrid_synchronization = HYBRID,
+    .optimism_throttling = OPTIMISM_THROTTLING,
     .serial = false,
     .dispatcher = ProcessEvent,
+    .reverse_dispatcher = REVERSE ? ReverseEvent : NULL,
     .committed = CanEnd,
 };
 
 int main(void)
 {
+	// Newton's iterations double the count of correct low bits of the inverse at each step
+	multiplier_inv = multiplier;
+	for(int i = 0; i < 6; ++i)
+		multiplier_inv *= 2 - multiplier * multiplier_inv;
+
 	RootsimInit(&conf);
 	return RootsimRun();
 }
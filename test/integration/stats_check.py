@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+# SPDX-License-Identifier: GPL-3.0-only
+
+"""
+This script checks the thread metrics in the statistics file of a simulation run against some expectations.
+
+The script requires the path to the rootsim_stats.py script, the path to the statistics file and one or more
+expectations in the form <metric><operator><value>, where <metric> is the name of a thread metric, or the ratio of two
+of them separated by a slash, and <operator> is one of ==, !=, <=, >=, < and >. The metrics are aggregated across GVTs,
+threads and nodes. The script fails if any of the expectations is not met.
+"""
+import operator
+import re
+import runpy
+import sys
+
+OPERATORS = {"==": operator.eq, "!=": operator.ne, "<=": operator.le, ">=": operator.ge, "<": operator.lt,
+             ">": operator.gt}
+EXPECTATION_REGEX = re.compile(r"(.+?)(==|!=|<=|>=|<|>)(\d+(?:\.\d+)?)")
+
+
+def metric_get(stats, metric):
+    """
+    Get the value of a metric, aggregated across GVTs, threads and nodes
+
+    :param stats: the parsed statistics file
+    :param metric: the name of the metric, or the names of two metrics separated by a slash to get their ratio
+    :return: the value of the metric
+    """
+    names = metric.split("/")
+    values = [stats.thread_metric_get(name, aggregate_gvts=True, aggregate_nodes=True) for name in names]
+    if len(values) == 1:
+        return values[0]
+    return values[0] / values[1] if values[1] else float("inf")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 4:
+        print("Need the rootsim_stats.py path, the statistics file and at least an expectation!", file=sys.stderr)
+        sys.exit(1)
+
+    STATS = runpy.run_path(sys.argv[1])["RSStats"](sys.argv[2])
+    FAILED = False
+    for expectation in sys.argv[3:]:
+        match = EXPECTATION_REGEX.fullmatch(expectation)
+        if match is None:
+            print(f"Malformed expectation {expectation}", file=sys.stderr)
+            sys.exit(1)
+
+        value = metric_get(STATS, match[1])
+        if not OPERATORS[match[2]](value, float(match[3])):
+            print(f"Expected {expectation}, got {match[1]} = {value}", file=sys.stderr)
+            FAILED = True
+
+    sys.exit(1 if FAILED else 0)
@@ -12,6 +12,7 @@
 
 #include <lp/lp.h>
 #include <mm/buddy/buddy.h>
+#include <mm/ckpt_allocator.h>
 #include <mock.h>
 
 #include <stdlib.h>
@@ -21,9 +22,11 @@
 static void write_allocations(uint64_t **allocations, unsigned allocations_cnt, unsigned block_size,
     test_rng_state *b_rng_p)
 {
-	for(unsigned i = 0; i < allocations_cnt; ++i)
+	for(unsigned i = 0; i < allocations_cnt; ++i) {
+		__write_mem(allocations[i], block_size);
 		for(unsigned j = 0; j < block_size / sizeof(uint64_t); ++j)
 			allocations[i][j] = rng_random_u(b_rng_p);
+	}
 }
 
 static int check_and_free_allocations(uint64_t **allocations, unsigned allocations_cnt, unsigned block_size,
@@ -96,7 +99,30 @@ int model_allocator_test(_unused void *_)
 	errs += *mem != 0;
 	rs_free(mem);
 
+	// the writes outside the LP memory, or outside any LP, are ignored
+	uint64_t *heap = malloc(sizeof(*heap));
+	__write_mem(heap, sizeof(*heap));
+	__write_mem(&errs, sizeof(errs));
+	current_lp = NULL;
+	__write_mem(heap, sizeof(*heap));
+	current_lp = lp;
+	free(heap);
+
+	// a write marked from the cache of the last buffer hit lands in the bitmap of the right buddy system
+	unsigned char *chunk = rs_malloc(1 << B_BLOCK_EXP);
+	array_count_t k = array_count(lp->mm_state.buddies);
+	while(array_get_at(lp->mm_state.buddies, --k)->base_mem > chunk)
+		;
+	struct buddy_state *b = array_get_at(lp->mm_state.buddies, k);
+	unsigned i = ((chunk - b->base_mem) >> B_BLOCK_EXP) + (1 << (B_TOTAL_EXP - 2 * B_BLOCK_EXP + 1));
+	__write_mem(chunk, 1);
+	bitmap_reset(b->dirty, i);
+	__write_mem(chunk + 1, 1);
+	errs += !bitmap_check(b->dirty, i);
+	rs_free(chunk);
+
 	model_allocator_lp_fini(&lp->mm_state);
+	ckpt_allocator_fini();
 
 	return errs;
 }
@@ -11,6 +11,7 @@
 #include <test.h>
 
 #include <lp/lp.h>
+#include <mm/ckpt_allocator.h>
 #include <mock.h>
 
 #include <stdlib.h>
@@ -46,7 +47,7 @@ static void allocation_init(struct alc *alc)
 		abort();
 	}
 	alc->c = c;
-	//	__write_mem(alc->ptr, alc->c * sizeof(unsigned));
+	__write_mem(alc->ptr, alc->c * sizeof(unsigned));
 
 	while(c--) {
 		unsigned v = test_random_u();
@@ -95,7 +96,7 @@ static void allocation_partial_write(struct alc *alc, unsigned p)
 		unsigned e = test_random_range(c + 1);
 		unsigned l = test_random_range(e + 1);
 
-		//		__write_mem(alc[i].ptr + l, (e - l) * sizeof(unsigned));
+		__write_mem(alc[i].ptr + l, (e - l) * sizeof(unsigned));
 
 		for(unsigned j = l; j < e; ++j) {
 			unsigned v = test_random_u();
@@ -201,6 +202,7 @@ int model_allocator_test_hard(_unused void *_)
 
 	allocation_all_fini(alc);
 	model_allocator_lp_fini(&lp->mm_state);
+	ckpt_allocator_fini();
 
 	return 0;
 }
@@ -0,0 +1,49 @@
+/**
+ * @file test/tests/mm/ckpt_allocator.c
+ *
+ * @brief Test: checkpoint buffers allocator
+ *
+ * A test of the thread-local allocator serving the checkpoint buffers
+ *
+ * SPDX-FileCopyrightText: 2008-2025 HPDCS Group <rootsim@googlegroups.com>
+ * SPDX-License-Identifier: GPL-3.0-only
+ */
+#include <test.h>
+
+#include <mm/ckpt_allocator.h>
+
+#include <stdalign.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CKPT_TEST_BUFFERS 512
+#define CKPT_TEST_MAX_SIZE (1U << 20)
+
+int ckpt_allocator_test(_unused void *_)
+{
+	static unsigned char *bufs[CKPT_TEST_BUFFERS];
+	static size_t sizes[CKPT_TEST_BUFFERS];
+
+	for(unsigned r = 0; r < 4; ++r) {
+		for(unsigned i = 0; i < CKPT_TEST_BUFFERS; ++i) {
+			sizes[i] = test_random_range(CKPT_TEST_MAX_SIZE >> (i % 12)) + 1;
+			bufs[i] = ckpt_allocator_alloc(sizes[i]);
+			test_assert(((uintptr_t)bufs[i] & (alignof(max_align_t) - 1)) == 0);
+			memset(bufs[i], (int)i, sizes[i]);
+		}
+
+		for(unsigned i = 0; i < CKPT_TEST_BUFFERS; ++i) {
+			test_assert(bufs[i][0] == (unsigned char)i);
+			test_assert(bufs[i][sizes[i] - 1] == (unsigned char)i);
+			ckpt_allocator_free(bufs[i]);
+		}
+
+		// the last released buffer is the first one served again for the same size
+		void *a = ckpt_allocator_alloc(sizes[CKPT_TEST_BUFFERS - 1]);
+		test_assert(a == bufs[CKPT_TEST_BUFFERS - 1]);
+		ckpt_allocator_free(a);
+	}
+
+	ckpt_allocator_fini();
+	return 0;
+}
@@ -11,16 +11,22 @@
 #include <test.h>
 
 #include <log/log.h>
+#include <mm/model_allocator.h>
 
 extern int model_allocator_test(void *);
 extern int model_allocator_test_hard(void *);
 extern int parallel_malloc_test(void *);
+extern int ckpt_allocator_test(void *);
 
 int main(void)
 {
 	log_init(stdout);
+	model_allocator_global_init();
 
 	test("Testing buddy system", model_allocator_test, NULL);
 	test("Testing buddy system (hard test)", model_allocator_test_hard, NULL);
 	test("Testing parallel memory operations", parallel_malloc_test, NULL);
+	test("Testing checkpoint allocator", ckpt_allocator_test, NULL);
+
+	model_allocator_global_fini();
 }